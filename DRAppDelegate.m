@@ -17,6 +17,7 @@
 // Dancing Robots tile sets (the defaults below) may not be used in your own 
 // app without permission.
 #define IMAGERY_DATASET 1
+#define OVERLAY_DATASET 0
 #define TERRAIN_DATASET 1
 
 
@@ -117,6 +118,34 @@
     }
     self.viewController.pager.imageryDatabase = database;
     
+    // setup overlay dataset, drawn over the imagery
+    database = [RATileDatabase new];
+    database.bounds = CGRectMake( -180,-90,360,180 );
+    database.googleTileConvention = YES;
+    database.minzoom = 2;
+    
+    switch ( OVERLAY_DATASET ) {
+        case 1:
+            // Stamen Maps Toner Labels - http://maps.stamen.com/toner
+            database.baseUrlStrings = [NSArray arrayWithObjects:
+                @"http://a.tile.stamen.com/toner-labels/{z}/{x}/{y}.png",
+                @"http://b.tile.stamen.com/toner-labels/{z}/{x}/{y}.png",
+                @"http://c.tile.stamen.com/toner-labels/{z}/{x}/{y}.png",
+                nil];
+            database.maxzoom = 17;
+            break;
+            
+        default:
+            database = nil;
+            break;
+    }
+    
+    if ( database ) {
+        RAImageryLayer * overlay = [[RAImageryLayer alloc] initWithDatabase:database];
+        overlay.opacity = 0.8f;
+        self.viewController.pager.overlays = [NSArray arrayWithObject:overlay];
+    }
+    
     // setup height tile dataset
     database = [RATileDatabase new];
     database.bounds = CGRectMake( -180,-90,360,180 );
@@ -168,6 +197,7 @@
 {
     // Use this method to release shared resources, save user data, invalidate timers, and store enough application state information to restore your application to its current state in case it is terminated later. 
     // If your application supports background execution, this method is called instead of applicationWillTerminate: when the user quits.
+    [self.viewController saveState];
 }
 
 - (void)applicationWillEnterForeground:(UIApplication *)application
@@ -183,6 +213,7 @@
 - (void)applicationWillTerminate:(UIApplication *)application
 {
     // Called when the application is about to terminate. Save data if appropriate. See also applicationDidEnterBackground:.
+    [self.viewController saveState];
 }
 
 @end
@@ -0,0 +1,80 @@
+//
+//  RABatchBuilder.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/6/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#include "RABatchBuilder.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __APPLE__
+#include <TargetConditionals.h>
+#endif
+
+// the host unit tests supply their own GLES2 header
+#if TARGET_OS_IPHONE
+#include <OpenGLES/ES2/gl.h>
+#else
+#include <GLES2/gl2.h>
+#endif
+
+static int CompareItems( const void * a, const void * b )
+{
+    const RABatchItem * ia = (const RABatchItem *)a;
+    const RABatchItem * ib = (const RABatchItem *)b;
+
+    if ( ia->transform != ib->transform ) return ( ia->transform < ib->transform ) ? -1 : 1;
+    for( int u = 0; u < kRABatchTextureUnits; u++ ) {
+        if ( ia->textures[u] != ib->textures[u] ) return ( ia->textures[u] < ib->textures[u] ) ? -1 : 1;
+    }
+    if ( ia->page != ib->page ) return ( ia->page < ib->page ) ? -1 : 1;
+    if ( ia->slot != ib->slot ) return ( ia->slot < ib->slot ) ? -1 : 1;
+    return 0;
+}
+
+static int SameBatch( const RABatchItem * item, const RABatch * batch )
+{
+    return item->transform == batch->transform && item->page == batch->page &&
+           memcmp( item->textures, batch->textures, sizeof(item->textures) ) == 0;
+}
+
+size_t RABatchBuild( RABatchItem * items, size_t count, RABatch * batches )
+{
+    if ( count == 0 ) return 0;
+
+    // ordering slots within a batch keeps its index stream stable while the view holds still
+    qsort( items, count, sizeof(RABatchItem), CompareItems );
+
+    size_t batchCount = 0;
+    for( size_t i = 0; i < count; i++ ) {
+        if ( batchCount == 0 || ! SameBatch( &items[i], &batches[batchCount-1] ) ) {
+            RABatch * batch = &batches[batchCount++];
+            batch->transform = items[i].transform;
+            memcpy( batch->textures, items[i].textures, sizeof(batch->textures) );
+            batch->page = items[i].page;
+            batch->firstItem = i;
+            batch->itemCount = 0;
+        }
+        batches[batchCount-1].itemCount++;
+    }
+
+    return batchCount;
+}
+
+size_t RABatchDraw( const RABatch * batches, size_t count, size_t indicesPerItem, unsigned int mode, RABatchPrepareFunc prepare, void * context )
+{
+    for( size_t b = 0; b < count; b++ ) {
+        const RABatch * batch = &batches[b];
+        if ( prepare ) prepare( batch, context );
+
+        // the batch's items are consecutive in the sorted order, so their indices are too
+        glDrawElements( mode, (GLsizei)( batch->itemCount * indicesPerItem ), GL_UNSIGNED_SHORT,
+                        (const GLvoid *)( batch->firstItem * indicesPerItem * sizeof(GLushort) ) );
+    }
+
+    return count;
+}
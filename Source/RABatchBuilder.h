@@ -0,0 +1,45 @@
+//
+//  RABatchBuilder.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/6/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#ifndef EarthViewExample_RABatchBuilder_h
+#define EarthViewExample_RABatchBuilder_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define kRABatchTextureUnits (3)   // base imagery and its overlays
+
+// one mesh to draw from a shared vertex page; items with equal keys can share a draw call
+typedef struct {
+    uint32_t    transform;  // index of the model matrix
+    uint32_t    textures[kRABatchTextureUnits];    // texture name per unit, 0 if unused
+    uint32_t    page;       // vertex page
+    uint32_t    slot;       // mesh within the page
+} RABatchItem;
+
+// a run of items in the sorted array with the same transform, textures and page
+typedef struct {
+    uint32_t    transform;
+    uint32_t    textures[kRABatchTextureUnits];
+    uint32_t    page;
+    size_t      firstItem;
+    size_t      itemCount;
+} RABatch;
+
+// sorts the items by key and slot, and writes one batch per run of equal keys
+// batches must have room for count entries; returns the number of batches
+size_t RABatchBuild( RABatchItem * items, size_t count, RABatch * batches );
+
+// binds the state a batch needs, such as its vertex page, textures and transform
+typedef void (*RABatchPrepareFunc)( const RABatch * batch, void * context );
+
+// one draw call per batch from the bound element buffer, which holds indicesPerItem unsigned
+// short indices for each of the sorted items in turn; returns the number of draw calls
+size_t RABatchDraw( const RABatch * batches, size_t count, size_t indicesPerItem, unsigned int mode, RABatchPrepareFunc prepare, void * context );
+
+#endif
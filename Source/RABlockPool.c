@@ -0,0 +1,111 @@
+//
+//  RABlockPool.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/5/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#include "RABlockPool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// four classes per power of two from 1 KB, so a block wastes at most a fifth of itself;
+// the largest class is 3.5 MB, bigger blocks aren't pooled
+#define kMinClassSize       (1024)
+#define kStepsPerOctave     (4)
+
+
+static size_t ClassSize( int c )
+{
+    size_t octave = (size_t)kMinClassSize << ( c / kStepsPerOctave );
+    return octave + ( c % kStepsPerOctave ) * ( octave / kStepsPerOctave );
+}
+
+static int ClassForLength( size_t length )
+{
+    for( int c = 0; c < kBlockPoolClassCount; c++ ) {
+        if ( ClassSize(c) >= length ) return c;
+    }
+    return -1;
+}
+
+void RABlockPoolInit( RABlockPool * pool, size_t maxRetainedBytes )
+{
+    memset( pool, 0, sizeof(RABlockPool) );
+    pool->maxRetainedBytes = maxRetainedBytes;
+}
+
+void RABlockPoolDestroy( RABlockPool * pool )
+{
+    RABlockPoolPurge( pool );
+    for( int c = 0; c < kBlockPoolClassCount; c++ ) {
+        free( pool->freeBlocks[c] );
+        pool->freeBlocks[c] = NULL;
+        pool->freeCapacity[c] = 0;
+    }
+}
+
+size_t RABlockPoolBlockSize( size_t length )
+{
+    int c = ClassForLength( length );
+    return ( c >= 0 ) ? ClassSize(c) : length;
+}
+
+void * RABlockPoolAcquire( RABlockPool * pool, size_t length )
+{
+    int c = ClassForLength( length );
+    if ( c >= 0 && pool->freeCount[c] > 0 ) {
+        pool->reuseCount++;
+        pool->retainedBytes -= ClassSize(c);
+        return pool->freeBlocks[c][ --pool->freeCount[c] ];
+    }
+
+    pool->allocationCount++;
+    return malloc( c >= 0 ? ClassSize(c) : length );
+}
+
+void * RABlockPoolCopy( RABlockPool * pool, const void * data, size_t length )
+{
+    void * block = RABlockPoolAcquire( pool, length );
+    if ( block ) {
+        memcpy( block, data, length );
+        pool->bytesCopied += length;
+    }
+    return block;
+}
+
+void RABlockPoolRelease( RABlockPool * pool, void * block, size_t length )
+{
+    if ( block == NULL ) return;
+
+    int c = ClassForLength( length );
+    if ( c >= 0 && pool->retainedBytes + ClassSize(c) <= pool->maxRetainedBytes ) {
+        if ( pool->freeCount[c] == pool->freeCapacity[c] ) {
+            size_t capacity = ( pool->freeCapacity[c] > 0 ) ? 2 * pool->freeCapacity[c] : 16;
+            void ** blocks = (void **)realloc( pool->freeBlocks[c], capacity * sizeof(void *) );
+            if ( blocks == NULL ) {
+                free( block );
+                return;
+            }
+            pool->freeBlocks[c] = blocks;
+            pool->freeCapacity[c] = capacity;
+        }
+
+        pool->freeBlocks[c][ pool->freeCount[c]++ ] = block;
+        pool->retainedBytes += ClassSize(c);
+        return;
+    }
+
+    free( block );
+}
+
+void RABlockPoolPurge( RABlockPool * pool )
+{
+    for( int c = 0; c < kBlockPoolClassCount; c++ ) {
+        for( size_t i = 0; i < pool->freeCount[c]; i++ ) free( pool->freeBlocks[c][i] );
+        pool->freeCount[c] = 0;
+    }
+    pool->retainedBytes = 0;
+}
@@ -0,0 +1,40 @@
+//
+//  RABlockPool.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/5/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#ifndef EarthViewExample_RABlockPool_h
+#define EarthViewExample_RABlockPool_h
+
+#include <stddef.h>
+
+#define kBlockPoolClassCount (48)
+
+// recycles memory blocks by size class, so building meshes in steady state doesn't allocate;
+// not thread safe, callers lock around it
+typedef struct {
+    void **     freeBlocks[kBlockPoolClassCount];
+    size_t      freeCount[kBlockPoolClassCount];
+    size_t      freeCapacity[kBlockPoolClassCount];
+    size_t      maxRetainedBytes;   // free blocks kept for reuse
+    size_t      retainedBytes;
+    size_t      allocationCount;    // blocks that could not be reused
+    size_t      reuseCount;
+    size_t      bytesCopied;        // by RABlockPoolCopy
+} RABlockPool;
+
+void RABlockPoolInit( RABlockPool * pool, size_t maxRetainedBytes );
+void RABlockPoolDestroy( RABlockPool * pool );
+
+// contents are undefined; release with the same length
+void * RABlockPoolAcquire( RABlockPool * pool, size_t length );
+void * RABlockPoolCopy( RABlockPool * pool, const void * data, size_t length );
+void RABlockPoolRelease( RABlockPool * pool, void * block, size_t length );
+
+size_t RABlockPoolBlockSize( size_t length );   // bytes actually reserved for a length
+void RABlockPoolPurge( RABlockPool * pool );    // frees the blocks held for reuse
+
+#endif
@@ -0,0 +1,192 @@
+//
+//  RABoundingSphere.c
+//  RASceneGraphMac
+//
+//  Created by Ross Anderson on 2/17/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#include "RABoundingSphere.h"
+
+#include <GLKit/GLKVector2.h>
+#include <GLKit/GLKVector3.h>
+#include <GLKit/GLKMatrix4.h>
+#include <GLKit/GLKMathUtils.h>
+
+const RABoundingSphere RABoundingSphereInvalid = { { 0, 0, 0 }, -1.0f };
+
+RABoundingSphere RABoundingSphereMake( GLKVector3 center, float radius )
+{
+    RABoundingSphere bound = { center, radius };
+    return bound;
+}
+
+bool RABoundingSphereIsValid( RABoundingSphere bound )
+{
+    return bound.radius >= 0.0f;
+}
+
+float RABoundingSphereRadius2( RABoundingSphere bound )
+{
+    return bound.radius*bound.radius;
+}
+
+RABoundingSphere RABoundingSphereExpandByPoint( RABoundingSphere bound, GLKVector3 point )
+{
+    if ( RABoundingSphereIsValid(bound) )
+    {
+        GLKVector3 dv = GLKVector3Subtract( point, bound.center );
+        float r = GLKVector3Length( dv );
+        if ( r > bound.radius )
+        {
+            float dr = ( r - bound.radius ) * 0.5f;
+            dv = GLKVector3MultiplyScalar( dv, dr/r );
+            bound.center = GLKVector3Add( bound.center, dv );
+            bound.radius += dr;
+        }
+    }
+    else
+    {
+        bound.center = point;
+        bound.radius = 0.0;
+    }
+    
+    return bound;
+}
+
+RABoundingSphere RABoundingSphereExpandBySphere( RABoundingSphere bound, RABoundingSphere other )
+{
+    // the following code snippet was ported from OpenSceneGraph: BoundingSphere
+    
+    // ignore operation if incoming BoundingSphere is invalid
+    if ( !RABoundingSphereIsValid(other) ) return bound;
+    
+    // if the sphere is currently invalid, set to the provided sphere
+    if ( !RABoundingSphereIsValid(bound) ) return other;
+    
+    // calculate the distance between sphere centers   
+    double d = GLKVector3Distance( bound.center, other.center );
+    
+    // new sphere is already entirely inside this one
+    if ( d + other.radius <= bound.radius ) return bound;
+    
+    //  new sphere completely contains this one
+    if ( d + bound.radius <= other.radius ) return other;
+    
+    // build a new sphere that completely contains the other two
+    // the center point lies halfway along the line between the furthest
+    // points on the edges of the two spheres
+    
+    // computing those two points is ugly - so we'll use similar triangles
+    double new_radius = (bound.radius + d + other.radius ) * 0.5;
+    double ratio = ( new_radius - bound.radius ) / d ;
+    
+    bound.center.v[0] += ( other.center.v[0] - bound.center.v[0] ) * ratio;
+    bound.center.v[1] += ( other.center.v[1] - bound.center.v[1] ) * ratio;
+    bound.center.v[2] += ( other.center.v[2] - bound.center.v[2] ) * ratio;
+    
+    bound.radius = new_radius;
+    return bound;
+}
+
+bool RABoundingSphereContains( RABoundingSphere bound, GLKVector3 point )
+{
+    if ( bound.radius <= 0.0f ) return false;
+    
+    GLKVector3 diff = GLKVector3Subtract( point, bound.center );
+    return GLKVector3DotProduct(diff, diff) <= bound.radius*bound.radius;
+}
+
+bool RABoundingSphereIntersects( RABoundingSphere bound, RABoundingSphere other )
+{
+    if ( !RABoundingSphereIsValid(bound) || !RABoundingSphereIsValid(other) ) return false;
+    
+    GLKVector3 diff = GLKVector3Subtract( bound.center, other.center );
+
+    return ( GLKVector3DotProduct(diff, diff) <= (bound.radius + other.radius)*(bound.radius + other.radius));
+}
+
+bool RABoundingSphereIntersectsSegment( RABoundingSphere bound, GLKVector3 start, GLKVector3 end )
+{
+    if ( !RABoundingSphereIsValid(bound) ) return false;
+    
+    // distance from the center to the nearest point on the segment
+    GLKVector3 dir = GLKVector3Subtract( end, start );
+    GLKVector3 diff = GLKVector3Subtract( bound.center, start );
+    float length2 = GLKVector3DotProduct( dir, dir );
+    float t = ( length2 > 0.0f ) ? GLKVector3DotProduct( diff, dir ) / length2 : 0.0f;
+    if ( t < 0.0f ) t = 0.0f;
+    if ( t > 1.0f ) t = 1.0f;
+    
+    GLKVector3 nearest = GLKVector3Add( start, GLKVector3MultiplyScalar( dir, t ) );
+    GLKVector3 offset = GLKVector3Subtract( nearest, bound.center );
+    return GLKVector3DotProduct( offset, offset ) <= bound.radius*bound.radius;
+}
+
+RABoundingSphere RABoundingSphereTransform( RABoundingSphere bound, GLKMatrix4 m )
+{
+    RABoundingSphere newbounds;
+    
+    // this algorithm was ported from OpenSceneGraph: Transform.cpp
+    
+    GLKVector3 x_prime = bound.center;
+    x_prime.x += bound.radius;
+    x_prime = GLKMatrix4MultiplyAndProjectVector3( m, x_prime );
+    
+    GLKVector3 y_prime = bound.center;
+    y_prime.y += bound.radius;
+    y_prime = GLKMatrix4MultiplyAndProjectVector3( m, y_prime );
+    
+    GLKVector3 z_prime = bound.center;
+    z_prime.z += bound.radius;
+    z_prime = GLKMatrix4MultiplyAndProjectVector3( m, z_prime );
+    
+    newbounds.center = GLKMatrix4MultiplyAndProjectVector3( m, bound.center );
+    
+    // calculate the radius from center
+    float x_prime_radius = GLKVector3Length( GLKVector3Subtract( x_prime, newbounds.center ) );
+    float y_prime_radius = GLKVector3Length( GLKVector3Subtract( y_prime, newbounds.center ) );
+    float z_prime_radius = GLKVector3Length( GLKVector3Subtract( z_prime, newbounds.center ) );
+    
+    // choose the longest radius
+    newbounds.radius = x_prime_radius;
+    if (newbounds.radius < y_prime_radius) newbounds.radius = y_prime_radius;
+    if (newbounds.radius < z_prime_radius) newbounds.radius = z_prime_radius;
+
+    return newbounds;
+}
+
+RABoundingSphere RABoundingSphereTransformPlanar( RABoundingSphere bound, GLKMatrix4 m )
+{
+    // this function is similar to the above but the resulting sphere is projected
+    // only in X and Y. this is useful when projecting into normalize screen space
+    // where the Z axis is logarithmic, for example
+    
+    RABoundingSphere newbounds;
+    
+    GLKVector3 x_prime = bound.center;
+    x_prime.x += bound.radius;
+    x_prime = GLKMatrix4MultiplyAndProjectVector3( m, x_prime );
+    
+    GLKVector3 y_prime = bound.center;
+    y_prime.y += bound.radius;
+    y_prime = GLKMatrix4MultiplyAndProjectVector3( m, y_prime );
+    
+    GLKVector3 z_prime = bound.center;
+    z_prime.z += bound.radius;
+    z_prime = GLKMatrix4MultiplyAndProjectVector3( m, z_prime );
+    
+    newbounds.center = GLKMatrix4MultiplyAndProjectVector3( m, bound.center );
+    
+    // calculate the radius from center
+    float x_prime_radius = GLKVector2Length( GLKVector2Make( x_prime.x - newbounds.center.x, x_prime.y - newbounds.center.y ) );
+    float y_prime_radius = GLKVector2Length( GLKVector2Make( y_prime.x - newbounds.center.x, y_prime.y - newbounds.center.y ) );
+    float z_prime_radius = GLKVector2Length( GLKVector2Make( z_prime.x - newbounds.center.x, z_prime.y - newbounds.center.y ) );
+    
+    // choose the longest radius
+    newbounds.radius = x_prime_radius;
+    if (newbounds.radius < y_prime_radius) newbounds.radius = y_prime_radius;
+    if (newbounds.radius < z_prime_radius) newbounds.radius = z_prime_radius;
+    
+    return newbounds;
+}
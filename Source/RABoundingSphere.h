@@ -6,28 +6,34 @@
 //  Copyright (c) 2012 Ross Anderson. All rights reserved.
 //
 
-#import <Foundation/Foundation.h>
-#import <GLKit/GLKMathTypes.h>
+#ifndef RASceneGraphMac_RABoundingSphere_h
+#define RASceneGraphMac_RABoundingSphere_h
 
-@interface RABoundingSphere : NSObject {
+#include <stdbool.h>
+
+#include <GLKit/GLKMathTypes.h>
+
+// a bounding sphere is a plain value; a negative radius marks it as invalid (empty)
+typedef struct {
     GLKVector3  center;
     float       radius;
-}
+} RABoundingSphere;
 
-@property (assign, atomic) GLKVector3 center;
-@property (assign, atomic) float radius;
+extern const RABoundingSphere RABoundingSphereInvalid;
 
-@property (readonly) float radius2;
-@property (readonly) BOOL valid;
+RABoundingSphere RABoundingSphereMake( GLKVector3 center, float radius );
 
+bool RABoundingSphereIsValid( RABoundingSphere bound );
+float RABoundingSphereRadius2( RABoundingSphere bound );
 
-- (void)expandByPoint:(GLKVector3)point;
-- (void)expandByBoundingSphere:(RABoundingSphere *)bound;
+RABoundingSphere RABoundingSphereExpandByPoint( RABoundingSphere bound, GLKVector3 point );
+RABoundingSphere RABoundingSphereExpandBySphere( RABoundingSphere bound, RABoundingSphere other );
 
-- (BOOL)contains:(GLKVector3)point;
-- (BOOL)intersectsBoundingSphere:(RABoundingSphere *)bound;
+bool RABoundingSphereContains( RABoundingSphere bound, GLKVector3 point );
+bool RABoundingSphereIntersects( RABoundingSphere bound, RABoundingSphere other );
+bool RABoundingSphereIntersectsSegment( RABoundingSphere bound, GLKVector3 start, GLKVector3 end );
 
-- (RABoundingSphere *)transform:(GLKMatrix4)m;
-- (RABoundingSphere *)transformPlanar:(GLKMatrix4)m;
+RABoundingSphere RABoundingSphereTransform( RABoundingSphere bound, GLKMatrix4 m );
+RABoundingSphere RABoundingSphereTransformPlanar( RABoundingSphere bound, GLKMatrix4 m );
 
-@end
+#endif
@@ -0,0 +1,38 @@
+//
+//  RABufferPool.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/5/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// a block of memory from a buffer pool, given back to the pool when released
+@interface RAMeshBuffer : NSObject
+
+@property (readonly) void * bytes;
+@property (readonly) NSUInteger length;
+
+@end
+
+
+// hands out mesh buffers from a shared RABlockPool, so building tiles in steady state doesn't allocate
+@interface RABufferPool : NSObject
+
+@property (assign) NSUInteger maxRetainedBytes;     // free blocks kept for reuse, default 16 MB
+@property (readonly) NSUInteger retainedBytes;
+@property (readonly) NSUInteger allocationCount;    // blocks that could not be reused
+@property (readonly) NSUInteger reuseCount;
+@property (readonly) NSUInteger bytesCopied;        // by bufferWithBytes:length:
+
++ (RABufferPool *)sharedPool;
+
+// contents are undefined; may be called from any thread
+- (RAMeshBuffer *)bufferWithLength:(NSUInteger)length;
+- (RAMeshBuffer *)bufferWithBytes:(const void *)data length:(NSUInteger)length;
+
+// frees the blocks held for reuse
+- (void)purge;
+
+@end
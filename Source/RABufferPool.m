@@ -0,0 +1,149 @@
+//
+//  RABufferPool.m
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/5/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import "RABufferPool.h"
+
+#import "RABlockPool.h"
+
+static const NSUInteger kDefaultMaxRetainedBytes = 16*1024*1024;
+
+
+@interface RABufferPool ()
+- (void *)acquireBlockWithLength:(NSUInteger)length copying:(const void *)data;
+- (void)releaseBlock:(void *)block length:(NSUInteger)length;
+@end
+
+
+@implementation RAMeshBuffer {
+    RABufferPool *  _pool;
+}
+
+@synthesize bytes = _bytes;
+@synthesize length = _length;
+
+- (id)initWithPool:(RABufferPool *)pool length:(NSUInteger)length bytes:(const void *)data
+{
+    self = [super init];
+    if (self) {
+        _pool = pool;
+        _length = length;
+        _bytes = [pool acquireBlockWithLength:length copying:data];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_pool releaseBlock:_bytes length:_length];
+}
+
+@end
+
+
+@implementation RABufferPool {
+    RABlockPool     _pool;
+}
+
++ (RABufferPool *)sharedPool
+{
+    static RABufferPool * pool = nil;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        pool = [RABufferPool new];
+    });
+    return pool;
+}
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        RABlockPoolInit( &_pool, kDefaultMaxRetainedBytes );
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    RABlockPoolDestroy( &_pool );
+}
+
+- (NSUInteger)maxRetainedBytes
+{
+    @synchronized(self) {
+        return _pool.maxRetainedBytes;
+    }
+}
+
+- (void)setMaxRetainedBytes:(NSUInteger)bytes
+{
+    @synchronized(self) {
+        _pool.maxRetainedBytes = bytes;
+    }
+}
+
+- (NSUInteger)retainedBytes
+{
+    @synchronized(self) {
+        return _pool.retainedBytes;
+    }
+}
+
+- (NSUInteger)allocationCount
+{
+    @synchronized(self) {
+        return _pool.allocationCount;
+    }
+}
+
+- (NSUInteger)reuseCount
+{
+    @synchronized(self) {
+        return _pool.reuseCount;
+    }
+}
+
+- (NSUInteger)bytesCopied
+{
+    @synchronized(self) {
+        return _pool.bytesCopied;
+    }
+}
+
+- (RAMeshBuffer *)bufferWithLength:(NSUInteger)length
+{
+    return [[RAMeshBuffer alloc] initWithPool:self length:length bytes:NULL];
+}
+
+- (RAMeshBuffer *)bufferWithBytes:(const void *)data length:(NSUInteger)length
+{
+    return [[RAMeshBuffer alloc] initWithPool:self length:length bytes:data];
+}
+
+- (void)purge
+{
+    @synchronized(self) {
+        RABlockPoolPurge( &_pool );
+    }
+}
+
+- (void *)acquireBlockWithLength:(NSUInteger)length copying:(const void *)data
+{
+    @synchronized(self) {
+        return data ? RABlockPoolCopy( &_pool, data, length ) : RABlockPoolAcquire( &_pool, length );
+    }
+}
+
+- (void)releaseBlock:(void *)block length:(NSUInteger)length
+{
+    @synchronized(self) {
+        RABlockPoolRelease( &_pool, block, length );
+    }
+}
+
+@end
@@ -32,8 +32,14 @@ extern NSString * RACameraStateChangedNotification;
 @property (readonly) GLKVector3 topPlaneNormal;
 @property (readonly) GLKVector3 bottomPlaneNormal;
 
-- (void)calculateProjectionForBounds:(RABoundingSphere *)bound;
+- (void)calculateProjectionForBounds:(RABoundingSphere)bound;
 
 - (void)followCamera:(RACamera *)primary;
 
+// returns an independent copy positioned at the given modelview, with projection recalculated
+- (RACamera *)cameraWithModelViewMatrix:(GLKMatrix4)modelViewMatrix;
+
+// tests a world space bound against the view frustum
+- (BOOL)isBoundOnscreen:(RABoundingSphere)bound;
+
 @end
@@ -12,7 +12,7 @@
 NSString * RACameraStateChangedNotification = @"RACameraStateChangedNotification";
 
 @implementation RACamera {
-    RABoundingSphere *  _bound;
+    RABoundingSphere    _bound;
     __weak RACamera *   _follow;
     
     GLKMatrix4          _modelViewMatrix;
@@ -36,6 +36,7 @@ NSString * RACameraStateChangedNotification = @"RACameraStateChangedNotification
     if (self) {
         self.fieldOfView = 65.0f;
         _modelViewMatrix = GLKMatrix4Identity;
+        _bound = RABoundingSphereInvalid;
     }
     return self;
 }
@@ -45,7 +46,7 @@ NSString * RACameraStateChangedNotification = @"RACameraStateChangedNotification
     camera.viewport = self.viewport;
     camera.fieldOfView = self.fieldOfView;
     camera.modelViewMatrix = self.modelViewMatrix;
-    if ( _bound ) [camera calculateProjectionForBounds:_bound];
+    if ( RABoundingSphereIsValid(_bound) ) [camera calculateProjectionForBounds:_bound];
     if ( _follow ) [camera followCamera:_follow];
     return camera;
 }
@@ -71,7 +72,7 @@ NSString * RACameraStateChangedNotification = @"RACameraStateChangedNotification
     return _projectionMatrix;
 }
 
-- (void)calculateProjectionForBounds:(RABoundingSphere *)bound {
+- (void)calculateProjectionForBounds:(RABoundingSphere)bound {
     _bound = bound;
     
     _aspect = fabsf(viewport.size.width / viewport.size.height);
@@ -101,6 +102,33 @@ NSString * RACameraStateChangedNotification = @"RACameraStateChangedNotification
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(followCameraFromNotification:) name:RACameraStateChangedNotification object:primary];
 }
 
+- (RACamera *)cameraWithModelViewMatrix:(GLKMatrix4)modelViewMatrix {
+    RACamera * camera = [[[self class] alloc] init];
+    camera.viewport = self.viewport;
+    camera.fieldOfView = self.fieldOfView;
+    camera.modelViewMatrix = modelViewMatrix;
+    if ( RABoundingSphereIsValid(_bound) ) [camera calculateProjectionForBounds:_bound];
+    return camera;
+}
+
+- (BOOL)isBoundOnscreen:(RABoundingSphere)bound {
+    // convert the bounding sphere center into camera space
+    GLKVector3 s = GLKMatrix4MultiplyAndProjectVector3( self.modelViewMatrix, bound.center );
+    float radius = bound.radius;
+    
+    // test against near/far planes
+    if ( s.z - radius > -_near ) return NO;
+    if ( s.z + radius < -_far ) return NO;
+    
+    // left, right, top, bottom planes
+    if ( GLKVector3DotProduct( _leftPlaneNormal, s ) > radius ) return NO;
+    if ( GLKVector3DotProduct( _rightPlaneNormal, s ) > radius ) return NO;
+    if ( GLKVector3DotProduct( _topPlaneNormal, s ) > radius ) return NO;
+    if ( GLKVector3DotProduct( _bottomPlaneNormal, s ) > radius ) return NO;
+    
+    return YES;
+}
+
 - (void)followCameraFromNotification:(NSNotification *)note {
     RACamera * primary = note.object;
     
@@ -0,0 +1,51 @@
+//
+//  RACompiledGraph.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/2/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <GLKit/GLKMathTypes.h>
+
+#import "RANode.h"
+#import "RABoundingSphere.h"
+
+typedef enum {
+    RACompiledKindNode = 0,
+    RACompiledKindGroup,
+    RACompiledKindTransform,
+    RACompiledKindGeometry,
+    RACompiledKindPageNode
+} RACompiledKind;
+
+// nodes are stored depth first, so the descendants of entry i are the range [i+1, subtreeEnd)
+typedef struct {
+    __unsafe_unretained RANode *    node;   // retained by the graph
+    RACompiledKind                  kind;
+    NSInteger                       parent; // -1 for the root
+    NSUInteger                      subtreeEnd;
+    GLKMatrix4                      worldTransform;
+    RABoundingSphere                worldBound;
+} RACompiledNode;
+
+
+// a linear snapshot of a node hierarchy with cached world transforms and bounds
+@interface RACompiledGraph : NSObject
+
+@property (readonly, strong) RANode * root;
+@property (readonly) NSUInteger count;
+
+- (id)initWithRoot:(RANode *)root;
+
+// these may be called from any thread
+- (void)invalidateStructure;
+- (void)invalidateNode:(RANode *)node;
+
+// recompiles or refreshes dirty subtrees, call before iterating
+- (void)update;
+
+- (const RACompiledNode *)nodes;
+
+@end
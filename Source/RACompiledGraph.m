@@ -0,0 +1,183 @@
+//
+//  RACompiledGraph.m
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/2/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import "RACompiledGraph.h"
+
+#import <GLKit/GLKMatrix4.h>
+
+#import "RABoundingSphere.h"
+#import "RAGroup.h"
+#import "RATransform.h"
+#import "RAGeometry.h"
+#import "RAPageNode.h"
+
+
+@implementation RACompiledGraph {
+    NSMutableArray *    _retainedNodes;
+    RACompiledNode *    _nodes;
+    NSUInteger          _count;
+    NSUInteger          _capacity;
+
+    BOOL                _structureDirty;
+    NSMutableIndexSet * _dirtyIndexes;
+}
+
+@synthesize root = _root;
+@synthesize count = _count;
+
+- (id)initWithRoot:(RANode *)root
+{
+    self = [super init];
+    if (self) {
+        _root = root;
+        _retainedNodes = [NSMutableArray array];
+        _dirtyIndexes = [NSMutableIndexSet indexSet];
+        _structureDirty = YES;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if ( _nodes ) free( _nodes );
+}
+
+- (const RACompiledNode *)nodes
+{
+    return _nodes;
+}
+
+- (void)invalidateStructure
+{
+    @synchronized(self) {
+        _structureDirty = YES;
+    }
+}
+
+- (void)invalidateNode:(RANode *)node
+{
+    @synchronized(self) {
+        NSInteger idx = node.graphIndex;
+        if ( _structureDirty || idx < 0 || idx >= _count || _nodes[idx].node != node ) return;
+
+        [_dirtyIndexes addIndex:idx];
+    }
+}
+
+#pragma mark Compilation
+
+- (RACompiledKind)kindOfNode:(RANode *)node
+{
+    // most derived class first
+    if ( [node isKindOfClass:[RATransform class]] ) return RACompiledKindTransform;
+    if ( [node isKindOfClass:[RAGroup class]] ) return RACompiledKindGroup;
+    if ( [node isKindOfClass:[RAGeometry class]] ) return RACompiledKindGeometry;
+    if ( [node isKindOfClass:[RAPageNode class]] ) return RACompiledKindPageNode;
+    return RACompiledKindNode;
+}
+
+- (void)appendNode:(RANode *)node withParent:(NSInteger)parent
+{
+    if ( _count == _capacity ) {
+        _capacity = ( _capacity > 0 ) ? 2 * _capacity : 64;
+        _nodes = (RACompiledNode *)realloc( _nodes, _capacity * sizeof(RACompiledNode) );
+    }
+
+    NSUInteger idx = _count++;
+    [_retainedNodes addObject:node];
+
+    RACompiledNode * entry = &_nodes[idx];
+    entry->node = node;
+    entry->kind = [self kindOfNode:node];
+    entry->parent = parent;
+
+    node.graph = self;
+    node.graphIndex = idx;
+
+    if ( entry->kind == RACompiledKindGroup || entry->kind == RACompiledKindTransform ) {
+        for( RANode * child in [(RAGroup *)node children] ) {
+            [self appendNode:child withParent:idx];
+        }
+    }
+
+    // the array may have been reallocated by the children
+    _nodes[idx].subtreeEnd = _count;
+}
+
+- (void)compile
+{
+    for( RANode * node in _retainedNodes ) {
+        if ( node.graph == self ) node.graph = nil;
+    }
+    [_retainedNodes removeAllObjects];
+    _count = 0;
+
+    if ( _root ) [self appendNode:_root withParent:-1];
+}
+
+#pragma mark Update
+
+- (void)refreshEntry:(NSUInteger)idx
+{
+    RACompiledNode * entry = &_nodes[idx];
+    GLKMatrix4 parentTransform = ( entry->parent >= 0 ) ? _nodes[entry->parent].worldTransform : GLKMatrix4Identity;
+
+    // transforms apply to their own children, so the node bound is placed by the parent's transform
+    if ( entry->kind == RACompiledKindTransform ) {
+        entry->worldTransform = GLKMatrix4Multiply( parentTransform, [(RATransform *)entry->node transform] );
+    } else {
+        entry->worldTransform = parentTransform;
+    }
+
+    RABoundingSphere bound = [entry->node bound];
+    if ( RABoundingSphereIsValid(bound) && entry->parent >= 0 ) {
+        entry->worldBound = RABoundingSphereTransform( bound, parentTransform );
+    } else {
+        entry->worldBound = bound;
+    }
+}
+
+- (void)update
+{
+    NSIndexSet * dirty = nil;
+
+    @synchronized(self) {
+        if ( _structureDirty ) {
+            [self compile];
+            _structureDirty = NO;
+
+            dirty = ( _count > 0 ) ? [NSIndexSet indexSetWithIndex:0] : [NSIndexSet indexSet];
+        } else {
+            dirty = [_dirtyIndexes copy];
+        }
+        [_dirtyIndexes removeAllIndexes];
+    }
+
+    if ( dirty.count == 0 ) return;
+
+    // refresh each dirty subtree once; ranges nested within an earlier one are skipped
+    __block NSUInteger coveredEnd = 0;
+    NSMutableIndexSet * ancestors = [NSMutableIndexSet indexSet];
+
+    [dirty enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        if ( idx < coveredEnd ) return;
+
+        NSUInteger end = _nodes[idx].subtreeEnd;
+        for( NSUInteger i = idx; i < end; i++ ) [self refreshEntry:i];
+        coveredEnd = end;
+
+        for( NSInteger p = _nodes[idx].parent; p >= 0; p = _nodes[p].parent ) [ancestors addIndex:p];
+    }];
+
+    // the enclosing bounds changed too, deepest first so parents see fresh children
+    [ancestors enumerateIndexesWithOptions:NSEnumerationReverse usingBlock:^(NSUInteger idx, BOOL *stop) {
+        if ( ! [dirty containsIndex:idx] ) [self refreshEntry:idx];
+    }];
+}
+
+@end
@@ -10,7 +10,14 @@
 
 #import "RANode.h"
 #import "RATextureWrapper.h"
+#import "RABufferPool.h"
 
+@class RAMeshAtlasSlot;
+
+// GLKit only names two texture coordinate attributes
+enum {
+    RAVertexAttribTexCoord2 = GLKVertexAttribTexCoord1 + 1
+};
 
 @interface RAGeometry : RANode
 
@@ -19,17 +26,36 @@
 @property (assign, nonatomic) NSInteger normalOffset;   // GLFloat X, Y, Z
 @property (assign, nonatomic) NSInteger colorOffset;    // GLFloat r, g, b, a
 @property (assign, nonatomic) NSInteger textureOffset;  // GLFloat s, t
+@property (assign, nonatomic) NSInteger texture1Offset; // GLFloat s, t; if N/A texture1 uses textureOffset
+@property (assign, nonatomic) NSInteger texture2Offset; // GLFloat s, t
 
 @property (strong, nonatomic) RATextureWrapper * texture0;
 @property (strong, nonatomic) RATextureWrapper * texture1;
+@property (strong, nonatomic) RATextureWrapper * texture2;
 @property (assign, nonatomic) GLKVector4 color;         // set 1st component to -1 to disable
 @property (assign, nonatomic) GLenum elementStyle;      // default: GL_TRIANGLES
+@property (readonly) NSUInteger dataSize;               // bytes of vertex and index data
+
+@property (readonly) RAMeshBuffer * objectBuffer;
+@property (readonly) NSUInteger objectStride;
+@property (readonly) RAMeshBuffer * indexBuffer;
+@property (readonly) NSUInteger indexStride;
+
+// set when the vertices live in a mesh atlas instead of the geometry's own buffers
+@property (strong, atomic) RAMeshAtlasSlot * atlasSlot;
 
 + (void)cleanupAll:(BOOL)all;
 
 - (void)setObjectData:(const void *)data withSize:(NSUInteger)length withStride:(NSUInteger)stride;
 - (void)setIndexData:(const void *)data withSize:(NSUInteger)length withStride:(NSUInteger)stride;
 
+// take ownership of filled buffers without copying; don't modify them afterwards
+- (void)setObjectBuffer:(RAMeshBuffer *)buffer withStride:(NSUInteger)stride;
+- (void)setIndexBuffer:(RAMeshBuffer *)buffer withStride:(NSUInteger)stride;
+
+// once the vertices are in a mesh atlas, the bound is kept and the buffers go back to the pool
+- (void)releaseClientData;
+
 // these methods must be called from within a context
 - (void)setupGL;
 - (void)releaseGL;
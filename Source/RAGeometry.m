@@ -17,6 +17,7 @@
 #import <libkern/OSAtomic.h>
 
 #import "RABoundingSphere.h"
+#import "RACompiledGraph.h"
 
 #define BUFFER_INVALID ((GLuint)-1)
 #define kMaxDeleteBatchSize (8)
@@ -28,9 +29,12 @@ static int64_t sGeometryObjectCount = 0;
 @property (assign) GLuint vertexArray;
 @property (assign) GLuint vertexBuffer;
 @property (assign) GLuint indexBuffer;
+@property (assign) NSUInteger vertexBufferSize;
+@property (assign) NSUInteger indexBufferSize;
 @end
 @implementation GLBufferSet
 @synthesize vertexArray=_vertexArray, vertexBuffer=_vertexBuffer, indexBuffer=_indexBuffer;
+@synthesize vertexBufferSize=_vertexBufferSize, indexBufferSize=_indexBufferSize;
 
 - (id)init
 {
@@ -71,21 +75,35 @@ static int64_t sGeometryObjectCount = 0;
     _vertexBuffer = BUFFER_INVALID;
     _indexBuffer = BUFFER_INVALID;
     _vertexArray = BUFFER_INVALID;
+    _vertexBufferSize = _indexBufferSize = 0;
 }
 @end
 
 
+static void UploadBufferData( GLenum target, RAMeshBuffer * data, NSUInteger * currentSize )
+{
+    if ( *currentSize == data.length ) {
+        // orphan the old storage so the driver doesn't wait for draws still using it
+        glBufferData(target, data.length, NULL, GL_STATIC_DRAW);
+        glBufferSubData(target, 0, data.length, data.bytes);
+    } else {
+        glBufferData(target, data.length, data.bytes, GL_STATIC_DRAW);
+        *currentSize = data.length;
+    }
+}
+
+
 @implementation RAGeometry {
     GLBufferSet *   _buffers;
     NSString *      _contextKey;
     
-    NSMutableData * _vertexData;
+    RAMeshBuffer *  _vertexData;
     GLint           _vertexStride;
     GLint           _positionOffset;
     GLint           _normalOffset;
     GLint           _colorOffset;
     
-    NSMutableData * _indexData;
+    RAMeshBuffer *  _indexData;
     GLint           _indexStride;
     
     BOOL            _vertexDataDirty;
@@ -95,10 +113,11 @@ static int64_t sGeometryObjectCount = 0;
 @synthesize positionOffset = _positionOffset;
 @synthesize normalOffset = _normalOffset;
 @synthesize colorOffset = _colorOffset;
-@synthesize textureOffset = _textureOffset;
-@synthesize texture0 = _texture0, texture1 = _texture1;
+@synthesize textureOffset = _textureOffset, texture1Offset = _texture1Offset, texture2Offset = _texture2Offset;
+@synthesize texture0 = _texture0, texture1 = _texture1, texture2 = _texture2;
 @synthesize color = _color;
 @synthesize elementStyle = _elementStyle;
+@synthesize atlasSlot = _atlasSlot;
 
 
 + (NSMutableSet *)geometryDeletionSetForKey:(NSString *)key {
@@ -154,6 +173,8 @@ static int64_t sGeometryObjectCount = 0;
         _normalOffset = -1;
         _colorOffset = -1;
         _textureOffset = -1;
+        _texture1Offset = -1;
+        _texture2Offset = -1;
         
         _color = GLKVector4Make(-1, -1, -1, -1);
         _elementStyle = GL_TRIANGLES;
@@ -192,14 +213,14 @@ static int64_t sGeometryObjectCount = 0;
 {
     if ( !_vertexData || !_indexData ) return;
         
-    size_t vertexCount = [_vertexData length]/_vertexStride;
+    size_t vertexCount = _vertexData.length/_vertexStride;
 
     GLKVector3 center = GLKVector3Make(0, 0, 0);
     float maximumRadius = 0;
 
     // calculate average vertex position
     for( unsigned int i = 0; i < vertexCount; ++i ) {
-        GLfloat * posPtr = (GLfloat *)( [_vertexData bytes] + i*_vertexStride + _positionOffset );
+        GLfloat * posPtr = (GLfloat *)( _vertexData.bytes + i*_vertexStride + _positionOffset );
         GLKVector3 pos = GLKVector3Make( posPtr[0], posPtr[1], posPtr[2] );
         
         center.x += pos.x;
@@ -212,7 +233,7 @@ static int64_t sGeometryObjectCount = 0;
     
     // calculate maximum distance from center
     for( unsigned int i = 0; i < vertexCount; ++i ) {
-        GLfloat * posPtr = (GLfloat *)( [_vertexData bytes] + i*_vertexStride + _positionOffset );
+        GLfloat * posPtr = (GLfloat *)( _vertexData.bytes + i*_vertexStride + _positionOffset );
         GLKVector3 pos = GLKVector3Make( posPtr[0], posPtr[1], posPtr[2] );
         
         float distance = GLKVector3Distance(center, pos);
@@ -220,22 +241,62 @@ static int64_t sGeometryObjectCount = 0;
         if ( distance > maximumRadius ) maximumRadius = distance;
     }
     
-    RABoundingSphere * newBound = [RABoundingSphere new];
-    newBound.center = center;
-    newBound.radius = maximumRadius;
-    _bound = newBound;
+    _bound = RABoundingSphereMake( center, maximumRadius );
+}
+
+- (NSUInteger)dataSize
+{
+    @synchronized(self) {
+        return _vertexData.length + _indexData.length;
+    }
+}
+
+- (RAMeshBuffer *)objectBuffer
+{
+    @synchronized(self) {
+        return _vertexData;
+    }
+}
+
+- (NSUInteger)objectStride
+{
+    @synchronized(self) {
+        return _vertexStride;
+    }
+}
+
+- (RAMeshBuffer *)indexBuffer
+{
+    @synchronized(self) {
+        return _indexData;
+    }
+}
+
+- (NSUInteger)indexStride
+{
+    @synchronized(self) {
+        return _indexStride;
+    }
 }
 
 - (void)setObjectData:(const void *)data withSize:(NSUInteger)length withStride:(NSUInteger)stride
+{
+    RAMeshBuffer * buffer = [[RABufferPool sharedPool] bufferWithBytes:data length:length];
+    [self setObjectBuffer:buffer withStride:stride];
+}
+
+- (void)setIndexData:(const void *)data withSize:(NSUInteger)length withStride:(NSUInteger)stride
+{
+    RAMeshBuffer * buffer = [[RABufferPool sharedPool] bufferWithBytes:data length:length];
+    [self setIndexBuffer:buffer withStride:stride];
+}
+
+- (void)setObjectBuffer:(RAMeshBuffer *)buffer withStride:(NSUInteger)stride
 {
     NSAssert( stride > 0, @"stride must be non-zero" );
     
     @synchronized(self) {
-        if ( [_vertexData length] == length ) {
-            memcpy( [_vertexData mutableBytes], data, length );
-        } else {
-            _vertexData = [NSMutableData dataWithBytes:data length:length];
-        }
+        _vertexData = buffer;
         _vertexStride = stride;
 
         // force re-gen of vertex buffer
@@ -243,18 +304,15 @@ static int64_t sGeometryObjectCount = 0;
     }
     
     [self dirtyBound];
+    [_graph invalidateNode:self];
 }
 
-- (void)setIndexData:(const void *)data withSize:(NSUInteger)length withStride:(NSUInteger)stride
+- (void)setIndexBuffer:(RAMeshBuffer *)buffer withStride:(NSUInteger)stride
 {
     NSAssert( stride > 0, @"stride must be non-zero" );
 
     @synchronized(self) {
-        if ( [_indexData length] == length ) {
-            memcpy( [_indexData mutableBytes], data, length );
-        } else {
-            _indexData = [NSMutableData dataWithBytes:data length:length];
-        }
+        _indexData = buffer;
         _indexStride = stride;
         
         // force re-gen of index buffer
@@ -262,6 +320,20 @@ static int64_t sGeometryObjectCount = 0;
     }
     
     [self dirtyBound];
+    [_graph invalidateNode:self];
+}
+
+- (void)releaseClientData
+{
+    NSAssert( self.atlasSlot != nil, @"only geometry drawn from an atlas can drop its vertices" );
+    
+    // the bound is calculated from the vertices, so fix it first
+    [self bound];
+    
+    @synchronized(self) {
+        _vertexData = nil;
+        _indexData = nil;
+    }
 }
 
 - (void)setupGL
@@ -279,13 +351,17 @@ static int64_t sGeometryObjectCount = 0;
         
         // set vertex data
         if ( _vertexDataDirty && _vertexData && _vertexStride > 0 ) {
-            glBufferData(GL_ARRAY_BUFFER, [_vertexData length], [_vertexData bytes], GL_STATIC_DRAW);
+            NSUInteger size = _buffers.vertexBufferSize;
+            UploadBufferData( GL_ARRAY_BUFFER, _vertexData, &size );
+            _buffers.vertexBufferSize = size;
             _vertexDataDirty = NO;
         }
         
         // set index data
         if ( _indexDataDirty && _indexData && _indexStride > 0 ) {
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, [_indexData length], [_indexData bytes], GL_STATIC_DRAW);
+            NSUInteger size = _buffers.indexBufferSize;
+            UploadBufferData( GL_ELEMENT_ARRAY_BUFFER, _indexData, &size );
+            _buffers.indexBufferSize = size;
             _indexDataDirty = NO;
         }
         
@@ -310,11 +386,19 @@ static int64_t sGeometryObjectCount = 0;
             glVertexAttribPointer(GLKVertexAttribTexCoord0, 2, GL_FLOAT, GL_FALSE, _vertexStride, (const GLvoid *)_textureOffset);
         }
 
-        if ( _textureOffset >= 0 && _texture1 ) {
+        if ( _texture1Offset >= 0 && _texture1 ) {
+            glEnableVertexAttribArray(GLKVertexAttribTexCoord1);
+            glVertexAttribPointer(GLKVertexAttribTexCoord1, 2, GL_FLOAT, GL_FALSE, _vertexStride, (const GLvoid *)_texture1Offset);
+        } else if ( _textureOffset >= 0 && _texture1 ) {
             glEnableVertexAttribArray(GLKVertexAttribTexCoord1);
             glVertexAttribPointer(GLKVertexAttribTexCoord1, 2, GL_FLOAT, GL_FALSE, _vertexStride, (const GLvoid *)_textureOffset);
         }
 
+        if ( _texture2Offset >= 0 && _texture2 ) {
+            glEnableVertexAttribArray(RAVertexAttribTexCoord2);
+            glVertexAttribPointer(RAVertexAttribTexCoord2, 2, GL_FLOAT, GL_FALSE, _vertexStride, (const GLvoid *)_texture2Offset);
+        }
+
         glBindVertexArrayOES(0);
     }
 }
@@ -351,16 +435,23 @@ static int64_t sGeometryObjectCount = 0;
             glBindTexture(GL_TEXTURE_2D, 0);
         }
 
+        glActiveTexture (GL_TEXTURE2);
+        if ( _texture2 ) {
+            glBindTexture(GL_TEXTURE_2D, _texture2.name);
+        } else {
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+
         glBindVertexArrayOES(_buffers.vertexArray);
 
-        if ( _indexStride > 0 && [_indexData length] > 0 ) {
+        if ( _indexStride > 0 && _indexData.length > 0 ) {
             GLenum type = -1;
             switch( _indexStride ) {
                 case 1: type = GL_UNSIGNED_BYTE; break;
                 case 2: type = GL_UNSIGNED_SHORT; break;
             }
 
-            glDrawElements(self.elementStyle, [_indexData length]/_indexStride, type, 0);
+            glDrawElements(self.elementStyle, _indexData.length/_indexStride, type, 0);
         } else {
             NSLog(@"-[%@ renderGL]: nothing to draw", self);
         }
@@ -9,6 +9,7 @@
 #import "RAGroup.h"
 
 #import "RABoundingSphere.h"
+#import "RACompiledGraph.h"
 
 
 @implementation RAGroup
@@ -32,10 +33,10 @@
 }
 
 - (void)calculateBound {
-    RABoundingSphere * newBound = [RABoundingSphere new];
-    [_children enumerateObjectsUsingBlock:^(RANode * child, NSUInteger idx, BOOL *stop) {
-        [newBound expandByBoundingSphere: [child bound]];
-    }];
+    RABoundingSphere newBound = RABoundingSphereInvalid;
+    for( RANode * child in _children ) {
+        newBound = RABoundingSphereExpandBySphere( newBound, [child bound] );
+    }
     _bound = newBound;
 }
 
@@ -45,6 +46,7 @@
     [_children addObject: node];
     node.parent = self;
     [self dirtyBound];
+    [_graph invalidateStructure];
 }
 
 - (void)removeChild:(RANode *)node {
@@ -53,6 +55,7 @@
     [_children removeObject: node];
     node.parent = nil;
     [self dirtyBound];
+    [_graph invalidateStructure];
 }
 
 - (BOOL)containsChild:(RANode *)node {
@@ -0,0 +1,29 @@
+//
+//  RAHeightField.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/3/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <GLKit/GLKMathTypes.h>
+
+// the terrain surface of a tile as a grid of ecef positions, shared between the threads
+// that build and pick it; the box hierarchy and ray tests are in RATerrainTree.c
+@interface RAHeightField : NSObject
+
+@property (readonly) NSUInteger width;
+@property (readonly) NSUInteger height;
+@property (readonly) NSUInteger nodeCount;
+
+// positions are copied from the first three floats of each vertex; strides are in floats
+- (id)initWithVertices:(const GLfloat *)vertices width:(NSUInteger)width height:(NSUInteger)height vertexStride:(NSUInteger)vertexStride rowStride:(NSUInteger)rowStride;
+
+// fraction is the hit distance along the segment; only hits nearer than its input value are reported
+- (BOOL)intersectSegmentFrom:(GLKVector3)start to:(GLKVector3)end fraction:(float *)fraction;
+
+// as above, but only against the cells within the given ranges of columns and rows
+- (BOOL)intersectSegmentFrom:(GLKVector3)start to:(GLKVector3)end fraction:(float *)fraction columns:(NSRange)columns rows:(NSRange)rows;
+
+@end
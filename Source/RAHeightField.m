@@ -0,0 +1,59 @@
+//
+//  RAHeightField.m
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/3/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import "RAHeightField.h"
+
+#import "RATerrainTree.h"
+
+
+@implementation RAHeightField {
+    RATerrainTree   _tree;
+}
+
+- (id)initWithVertices:(const GLfloat *)vertices width:(NSUInteger)width height:(NSUInteger)height vertexStride:(NSUInteger)vertexStride rowStride:(NSUInteger)rowStride
+{
+    self = [super init];
+    if (self) {
+        NSAssert( width > 1 && height > 1, @"a height field needs at least one cell" );
+        if ( ! RATerrainTreeInit( &_tree, vertices, (int)width, (int)height, (int)vertexStride, (int)rowStride ) ) return nil;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    RATerrainTreeDestroy( &_tree );
+}
+
+- (NSUInteger)width
+{
+    return _tree.width;
+}
+
+- (NSUInteger)height
+{
+    return _tree.height;
+}
+
+- (NSUInteger)nodeCount
+{
+    return _tree.nodeCount;
+}
+
+- (BOOL)intersectSegmentFrom:(GLKVector3)start to:(GLKVector3)end fraction:(float *)fraction
+{
+    return RATerrainTreeIntersect( &_tree, start.v, end.v, fraction, 0, 0, _tree.width - 1, _tree.height - 1 );
+}
+
+- (BOOL)intersectSegmentFrom:(GLKVector3)start to:(GLKVector3)end fraction:(float *)fraction columns:(NSRange)columns rows:(NSRange)rows
+{
+    return RATerrainTreeIntersect( &_tree, start.v, end.v, fraction,
+                                   (int)columns.location, (int)rows.location, (int)NSMaxRange(columns), (int)NSMaxRange(rows) );
+}
+
+@end
@@ -0,0 +1,65 @@
+//
+//  RAHeightMap.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/8/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#include "RAHeightMap.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+bool RAHeightMapInit( RAHeightMap * map, int width, int height )
+{
+    map->width = width;
+    map->height = height;
+    map->minHeight = map->maxHeight = 0.0f;
+    map->heights = ( width > 0 && height > 0 ) ? (float *)calloc( width * height, sizeof(float) ) : NULL;
+    return ( map->heights != NULL );
+}
+
+void RAHeightMapDestroy( RAHeightMap * map )
+{
+    free( map->heights );
+    map->heights = NULL;
+    map->width = map->height = 0;
+}
+
+void RAHeightMapUpdateRange( RAHeightMap * map )
+{
+    int count = map->width * map->height;
+    if ( count < 1 ) return;
+    
+    float lo = map->heights[0], hi = map->heights[0];
+    for( int i = 1; i < count; i++ ) {
+        float h = map->heights[i];
+        if ( h < lo ) lo = h;
+        if ( h > hi ) hi = h;
+    }
+    
+    map->minHeight = lo;
+    map->maxHeight = hi;
+}
+
+float RAHeightMapSample( const RAHeightMap * map, float s, float t )
+{
+    if ( map->heights == NULL ) return 0.0f;
+    
+    // snap to bounds of the grid
+    float x = fminf( fmaxf( s, 0.0f ), 1.0f ) * ( map->width - 1 );
+    float y = fminf( fmaxf( t, 0.0f ), 1.0f ) * ( map->height - 1 );
+    
+    int x0 = (int)x, y0 = (int)y;
+    int x1 = ( x0 + 1 < map->width ) ? x0 + 1 : x0;
+    int y1 = ( y0 + 1 < map->height ) ? y0 + 1 : y0;
+    float fx = x - x0, fy = y - y0;
+    
+    const float * row0 = map->heights + y0 * map->width;
+    const float * row1 = map->heights + y1 * map->width;
+    
+    float h0 = row0[x0] + ( row0[x1] - row0[x0] ) * fx;
+    float h1 = row1[x0] + ( row1[x1] - row1[x0] ) * fx;
+    return h0 + ( h1 - h0 ) * fy;
+}
@@ -0,0 +1,32 @@
+//
+//  RAHeightMap.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/8/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#ifndef EarthViewExample_RAHeightMap_h
+#define EarthViewExample_RAHeightMap_h
+
+#include <stdbool.h>
+
+// a grid of heights in meters, row 0 along the southern edge of the tile
+typedef struct {
+    float *     heights;
+    int         width;
+    int         height;
+    float       minHeight;
+    float       maxHeight;
+} RAHeightMap;
+
+bool RAHeightMapInit( RAHeightMap * map, int width, int height );     // heights are zeroed
+void RAHeightMapDestroy( RAHeightMap * map );
+
+// recalculates minHeight and maxHeight from the samples
+void RAHeightMapUpdateRange( RAHeightMap * map );
+
+// bilinear; s and t run from 0 to 1 across the grid and are clamped to it
+float RAHeightMapSample( const RAHeightMap * map, float s, float t );
+
+#endif
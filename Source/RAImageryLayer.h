@@ -0,0 +1,31 @@
+//
+//  RAImageryLayer.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/9/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "RATileDatabase.h"
+
+// samplers left in Shader.fsh after the base imagery
+#define kRAMaxImageryOverlays (2)
+
+extern NSString * RAImageryLayerVisibilityChangedNotification;   // posted when the opacity moves to or from zero
+
+
+// a tile set drawn over the base imagery, such as roads or labels
+@interface RAImageryLayer : NSObject
+
+@property (strong, nonatomic) RATileDatabase * database;
+@property (assign, atomic) float opacity;               // default: 1
+@property (assign, nonatomic) NSUInteger minzoom;       // default: the database's minzoom
+@property (assign, nonatomic) NSUInteger maxzoom;       // default: no limit, finer pages magnify the database's finest tiles
+
+- (id)initWithDatabase:(RATileDatabase *)database;
+
+- (BOOL)isVisibleAtZoom:(NSUInteger)zoom;     // NO at zero opacity, so the pager neither loads nor draws the layer
+
+@end
@@ -0,0 +1,56 @@
+//
+//  RAImageryLayer.m
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/9/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import "RAImageryLayer.h"
+
+NSString * RAImageryLayerVisibilityChangedNotification = @"RAImageryLayerVisibilityChangedNotification";
+
+
+@implementation RAImageryLayer
+
+@synthesize database = _database, opacity = _opacity;
+@synthesize minzoom = _minzoom, maxzoom = _maxzoom;
+
+- (id)initWithDatabase:(RATileDatabase *)database
+{
+    self = [super init];
+    if (self) {
+        _database = database;
+        _opacity = 1.0f;
+        
+        _minzoom = database.minzoom;
+        _maxzoom = NSUIntegerMax;
+    }
+    return self;
+}
+
+- (float)opacity
+{
+    @synchronized(self) {
+        return _opacity;
+    }
+}
+
+- (void)setOpacity:(float)opacity
+{
+    BOOL changed;
+    @synchronized(self) {
+        changed = ( ( _opacity > 0.0f ) != ( opacity > 0.0f ) );
+        _opacity = opacity;
+    }
+    
+    if ( changed ) [[NSNotificationCenter defaultCenter] postNotificationName:RAImageryLayerVisibilityChangedNotification object:self];
+}
+
+- (BOOL)isVisibleAtZoom:(NSUInteger)zoom
+{
+    // a transparent layer isn't worth fetching or uploading
+    return ( self.opacity > 0.0f && zoom >= self.minzoom && zoom <= self.maxzoom );
+}
+
+@end
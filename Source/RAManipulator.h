@@ -14,10 +14,29 @@
 #import "RACamera.h"
 #import "RAGeographicUtils.h"
 
+@class RATilePager;
+
+typedef enum {
+    RACameraLatitude = 0,
+    RACameraLongitude,
+    RACameraAzimuth,
+    RACameraElevation,
+    RACameraDistance,
+    RACameraFieldCount
+} RACameraField;
+
+typedef enum {
+    RAAnimationTimingLinear = 0,
+    RAAnimationTimingEaseIn,
+    RAAnimationTimingEaseOut,
+    RAAnimationTimingEaseInEaseOut
+} RAAnimationTiming;
+
 
 @interface RAManipulator : NSObject <UIGestureRecognizerDelegate>
 
 @property (strong) RACamera * camera;
+@property (weak) RATilePager * pager;     // optional, picks against its loaded terrain
 
 // animatable
 @property (assign) double latitude;
@@ -28,6 +47,23 @@
 
 - (void)addGesturesToView:(UIView *)view;
 
+// property changes between these calls update the camera once, when the outermost pair ends
+- (void)beginUpdates;
+- (void)endUpdates;
+
+// starting an animation replaces any running on that field
+- (void)animateField:(RACameraField)field to:(double)value duration:(NSTimeInterval)duration timing:(RAAnimationTiming)timing;
+- (void)stopAnimations;
+
+// called by the owner once per display frame, returns YES while animations are running
+- (BOOL)stepAnimations;
+
 - (void)flyToRegion:(CLRegion *)region;
 
+// find the surface under view points, returns the number of points that hit
+- (NSUInteger)intersectPoints:(const CGPoint *)points count:(NSUInteger)count latitudes:(double *)lats longitudes:(double *)lons hits:(BOOL *)hits;
+
+// cameras sampled along the path of any active animations, destination first
+- (NSArray *)predictedCamerasWithInterval:(NSTimeInterval)interval;
+
 @end
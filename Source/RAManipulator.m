@@ -8,7 +8,7 @@
 
 #import "RAManipulator.h"
 
-#import "TPPropertyAnimation.h"
+#import "RATilePager.h"
 
 static const RAPolarCoordinate kFreshPondCoord = { 42.384733, -71.149392, 1e7 };
 static const RAPolarCoordinate kPolarNone = { -1, -1, -1 };
@@ -27,6 +27,16 @@ typedef struct {
     double  distance;
 } CameraState;
 
+// one slot per camera field, so stepping animations never allocates
+typedef struct {
+    BOOL                        active;
+    double                      from;
+    double                      to;
+    NSTimeInterval              startTime;
+    NSTimeInterval              duration;
+    RAAnimationTiming   timing;
+} CameraAnimation;
+
 typedef enum {
     GestureNone = 0,
     GestureGeoDrag,
@@ -35,16 +45,70 @@ typedef enum {
     GestureTilt
 } GestureAction;
 
+static double ConstrainCameraField( RACameraField field, double value ) {
+    switch( field ) {
+        case RACameraLatitude:  return NormalizeLatitude(value);
+        case RACameraLongitude: return NormalizeLongitude(value);
+        case RACameraAzimuth:   return NormalizeLongitude(value);
+        case RACameraElevation: return MIN( MAX( value, 0. ), 90. );
+        case RACameraDistance:  return MIN( MAX( value, 200. ), 1.e7 );
+        default:                return value;
+    }
+}
+
+static double * CameraStateField( CameraState * state, RACameraField field ) {
+    switch( field ) {
+        case RACameraLatitude:  return &state->latitude;
+        case RACameraLongitude: return &state->longitude;
+        case RACameraAzimuth:   return &state->azimuth;
+        case RACameraElevation: return &state->elevation;
+        case RACameraDistance:  return &state->distance;
+        default:                return NULL;
+    }
+}
+
+static double InterpolateCameraAnimation( const CameraAnimation * anim, NSTimeInterval time ) {
+    double t = ( anim->duration > 0. ) ? ( time - anim->startTime ) / anim->duration : 1.;
+    if ( t < 0. ) t = 0.;
+    if ( t > 1. ) t = 1.;
+    
+    double position = t;
+    switch( anim->timing ) {
+        case RAAnimationTimingEaseIn:
+            position = t * t;
+            break;
+        case RAAnimationTimingEaseOut:
+            position = 1. - (t-1.)*(t-1.);
+            break;
+        case RAAnimationTimingEaseInEaseOut:
+            position = ( t < 0.5 ) ? 2.*t*t : 1. - 2.*(t-1.)*(t-1.);
+            break;
+        case RAAnimationTimingLinear:
+        default:
+            break;
+    }
+    
+    return anim->from + position * ( anim->to - anim->from );
+}
+
 @interface RAManipulator (PrivateMethods)
 - (void)updateCamera;
+- (void)setNeedsCameraUpdate;
 - (void)stop:(id)sender;
+- (NSUInteger)intersectPoints:(const CGPoint *)points count:(NSUInteger)count latitudes:(double *)lats longitudes:(double *)lons hits:(BOOL *)hits withState:(CameraState)aState;
 @end
 
 @implementation RAManipulator {
     CameraState     _state;
+    
+    CameraAnimation _animations[RACameraFieldCount];
+    NSUInteger      _animationEpoch;    // bumped when animations are stopped
+    
+    NSUInteger      _updateDepth;
+    BOOL            _cameraDirty;
 }
 
-@synthesize camera;
+@synthesize camera, pager;
 
 - (id)init
 {
@@ -55,11 +119,13 @@ typedef enum {
 }
 
 - (void)addGesturesToView:(UIView *)view {
+    [self beginUpdates];
     self.latitude = kFreshPondCoord.latitude;
     self.longitude = kFreshPondCoord.longitude;
     self.distance = kFreshPondCoord.height;
     self.azimuth = 0;
     self.elevation = 90;
+    [self endUpdates];
     
     // add gestures
     UIPinchGestureRecognizer * pinchRecognizer = [[UIPinchGestureRecognizer alloc] initWithTarget:self action:@selector(scale:)];
@@ -88,8 +154,8 @@ typedef enum {
 - (void)setLatitude:(double)latitude {
     NSAssert( !isnan(latitude), @"angle cannot be NAN" );
     
-    _state.latitude = NormalizeLatitude(latitude);
-    [self updateCamera];
+    _state.latitude = ConstrainCameraField(RACameraLatitude, latitude);
+    [self setNeedsCameraUpdate];
 }
 
 - (double)longitude {
@@ -99,8 +165,8 @@ typedef enum {
 - (void)setLongitude:(double)longitude {
     NSAssert( !isnan(longitude), @"angle cannot be NAN" );
     
-    _state.longitude = NormalizeLongitude(longitude);
-    [self updateCamera];
+    _state.longitude = ConstrainCameraField(RACameraLongitude, longitude);
+    [self setNeedsCameraUpdate];
 }
 
 - (double)azimuth {
@@ -110,8 +176,8 @@ typedef enum {
 - (void)setAzimuth:(double)azimuth {
     NSAssert( !isnan(azimuth), @"angle cannot be NAN" );
 
-    _state.azimuth = NormalizeLongitude(azimuth);
-    [self updateCamera];
+    _state.azimuth = ConstrainCameraField(RACameraAzimuth, azimuth);
+    [self setNeedsCameraUpdate];
 }
 
 - (double)elevation {
@@ -120,11 +186,9 @@ typedef enum {
 
 - (void)setElevation:(double)elevation {
     NSAssert( !isnan(elevation), @"angle cannot be NAN" );
-    if ( elevation <  0. ) elevation =  0.;
-    if ( elevation > 90. ) elevation = 90.;
     
-    _state.elevation = elevation;
-    [self updateCamera];
+    _state.elevation = ConstrainCameraField(RACameraElevation, elevation);
+    [self setNeedsCameraUpdate];
 }
 
 - (double)distance {
@@ -133,11 +197,113 @@ typedef enum {
 
 - (void)setDistance:(double)distance {
     NSAssert( !isnan(distance), @"distance cannot be NAN" );
-    if ( distance < 200. ) distance = 200.;
-    if ( distance > 1.e7 ) distance = 1.e7;
     
-    _state.distance = distance;
-    [self updateCamera];
+    _state.distance = ConstrainCameraField(RACameraDistance, distance);
+    [self setNeedsCameraUpdate];
+}
+
+#pragma mark Camera Updates
+
+- (void)beginUpdates {
+    _updateDepth++;
+}
+
+- (void)endUpdates {
+    NSAssert( _updateDepth > 0, @"unbalanced call to endUpdates" );
+    
+    if ( --_updateDepth == 0 && _cameraDirty ) [self updateCamera];
+}
+
+- (void)setNeedsCameraUpdate {
+    _cameraDirty = YES;
+    if ( _updateDepth == 0 ) [self updateCamera];
+}
+
+- (void)updateCamera {
+    _cameraDirty = NO;
+    self.camera.modelViewMatrix = [self modelViewMatrixForState:_state];
+}
+
+#pragma mark Animation
+
+- (void)animateField:(RACameraField)field to:(double)value duration:(NSTimeInterval)duration timing:(RAAnimationTiming)timing {
+    NSAssert( field < RACameraFieldCount, @"invalid camera field" );
+    NSAssert( !isnan(value), @"animated value cannot be NAN" );
+    
+    CameraAnimation * anim = &_animations[field];
+    anim->active = YES;
+    anim->from = *CameraStateField(&_state, field);
+    anim->to = value;
+    anim->startTime = [NSDate timeIntervalSinceReferenceDate];
+    anim->duration = duration;
+    anim->timing = timing;
+}
+
+- (void)stopAnimations {
+    for( int field = 0; field < RACameraFieldCount; field++ )
+        _animations[field].active = NO;
+    
+    _animationEpoch++;
+}
+
+- (BOOL)applyAnimationsToState:(CameraState *)state atTime:(NSTimeInterval)time {
+    BOOL running = NO;
+    
+    for( int field = 0; field < RACameraFieldCount; field++ ) {
+        const CameraAnimation * anim = &_animations[field];
+        if ( ! anim->active ) continue;
+        
+        *CameraStateField(state, field) = ConstrainCameraField(field, InterpolateCameraAnimation(anim, time));
+        if ( time < anim->startTime + anim->duration ) running = YES;
+    }
+    
+    return running;
+}
+
+- (BOOL)stepAnimations {
+    NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+    BOOL animating = NO;
+    
+    for( int field = 0; field < RACameraFieldCount; field++ ) animating |= _animations[field].active;
+    if ( ! animating ) return NO;
+    
+    // all fields change together, so the camera is only updated once per frame
+    BOOL running = [self applyAnimationsToState:&_state atTime:now];
+    [self setNeedsCameraUpdate];
+    
+    // fields that reached their target are left alone from now on
+    for( int field = 0; field < RACameraFieldCount; field++ ) {
+        CameraAnimation * anim = &_animations[field];
+        if ( anim->active && now >= anim->startTime + anim->duration ) anim->active = NO;
+    }
+    
+    return running;
+}
+
+- (CameraState)stateAtTime:(NSTimeInterval)time {
+    CameraState predicted = _state;
+    [self applyAnimationsToState:&predicted atTime:time];
+    return predicted;
+}
+
+- (NSArray *)predictedCamerasWithInterval:(NSTimeInterval)interval {
+    if ( interval <= 0. ) return [NSArray array];
+    
+    NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+    NSTimeInterval end = now;
+    for( int field = 0; field < RACameraFieldCount; field++ ) {
+        const CameraAnimation * anim = &_animations[field];
+        if ( anim->active && anim->startTime + anim->duration > end ) end = anim->startTime + anim->duration;
+    }
+    
+    // walk backwards from the destination so that it gets the highest priority
+    NSMutableArray * cameras = [NSMutableArray array];
+    for( NSTimeInterval t = end; t > now; t -= interval ) {
+        CameraState predicted = [self stateAtTime:t];
+        [cameras addObject:[self.camera cameraWithModelViewMatrix:[self modelViewMatrixForState:predicted]]];
+    }
+    
+    return cameras;
 }
 
 - (void)flyToRegion:(CLRegion *)region {
@@ -147,38 +313,21 @@ typedef enum {
     double distance = region.radius / self.camera.tanThetaOverTwo;
 
     // zoom in to that location
-    TPPropertyAnimation *anim = [TPPropertyAnimation propertyAnimationWithKeyPath:@"latitude"];
-    anim.duration = duration;
-    anim.fromValue = [NSNumber numberWithDouble:_state.latitude];
-    anim.toValue = [NSNumber numberWithDouble:region.center.latitude];
-    anim.timing = TPPropertyAnimationTimingEaseInEaseOut;
-    [anim beginWithTarget:self];
-    
-    anim = [TPPropertyAnimation propertyAnimationWithKeyPath:@"longitude"];
-    anim.duration = duration;
-    anim.fromValue = [NSNumber numberWithDouble:_state.longitude];
-    anim.toValue = [NSNumber numberWithDouble:region.center.longitude];
-    anim.timing = TPPropertyAnimationTimingEaseInEaseOut;
-    [anim beginWithTarget:self];
-    
-    anim = [TPPropertyAnimation propertyAnimationWithKeyPath:@"distance"];
-    anim.duration = duration;
-    anim.fromValue = [NSNumber numberWithDouble:_state.distance];
-    anim.toValue = [NSNumber numberWithDouble:distance];
-    anim.timing = TPPropertyAnimationTimingEaseInEaseOut;
-    [anim beginWithTarget:self];
+    [self animateField:RACameraLatitude to:region.center.latitude duration:duration timing:RAAnimationTimingEaseInEaseOut];
+    [self animateField:RACameraLongitude to:region.center.longitude duration:duration timing:RAAnimationTimingEaseInEaseOut];
+    [self animateField:RACameraDistance to:distance duration:duration timing:RAAnimationTimingEaseInEaseOut];
 }
 
 - (GLKMatrix4)modelViewMatrixForState:(CameraState)aState {
-    RAPolarCoordinate   surfaceCoord = { self.latitude, self.longitude, 0 };
+    RAPolarCoordinate   surfaceCoord = { aState.latitude, aState.longitude, 0 };
     GLKVector3          surfacePos = ConvertPolarToEcef(surfaceCoord);
     
     GLKMatrix4 surfaceTransform = GLKMatrix4MakeLookAt(surfacePos.x, surfacePos.y, surfacePos.z, 0, 0, 0, 0, 0, 1);
     
     GLKMatrix4 perspective = GLKMatrix4Identity;
-    perspective = GLKMatrix4Translate(perspective, 0, 0, ConvertHeightToEcef(-self.distance));
-    perspective = GLKMatrix4Rotate(perspective,  (90.-self.elevation) * (M_PI/180.), -1, 0, 0);
-    perspective = GLKMatrix4Rotate(perspective, self.azimuth * (M_PI/180.), 0, 0, 1);
+    perspective = GLKMatrix4Translate(perspective, 0, 0, ConvertHeightToEcef(-aState.distance));
+    perspective = GLKMatrix4Rotate(perspective,  (90.-aState.elevation) * (M_PI/180.), -1, 0, 0);
+    perspective = GLKMatrix4Rotate(perspective, aState.azimuth * (M_PI/180.), 0, 0, 1);
     
     GLKMatrix4 modelView = GLKMatrix4Multiply(perspective, surfaceTransform);
     return modelView;
@@ -186,32 +335,66 @@ typedef enum {
 
 - (BOOL)intersectPoint:(CGPoint)point atLatitude:(double*)lat atLongitude:(double*)lon withState:(CameraState)aState
 {
-    GLKVector3 swin = { point.x, point.y, 0 };
-    GLKVector3 ewin = { point.x, point.y, 1 };
+    BOOL hit = NO;
+    [self intersectPoints:&point count:1 latitudes:lat longitudes:lon hits:&hit withState:aState];
+    return hit;
+}
+
+- (NSUInteger)intersectPoints:(const CGPoint *)points count:(NSUInteger)count latitudes:(double *)lats longitudes:(double *)lons hits:(BOOL *)hits
+{
+    return [self intersectPoints:points count:count latitudes:lats longitudes:lons hits:hits withState:_state];
+}
+
+- (NSUInteger)intersectPoints:(const CGPoint *)points count:(NSUInteger)count latitudes:(double *)lats longitudes:(double *)lons hits:(BOOL *)hits withState:(CameraState)aState
+{
     int        viewport[4] = { self.camera.viewport.origin.x, self.camera.viewport.origin.y + self.camera.viewport.size.height, self.camera.viewport.size.width, -self.camera.viewport.size.height };
     GLKMatrix4 modelViewMatrix = [self modelViewMatrixForState:aState];
+    
+    GLKVector3 starts[count], ends[count], positions[count];
+    BOOL       ellipsoidHits[count], terrainHits[count];
+    
+    for( NSUInteger i = 0; i < count; i++ ) {
+        GLKVector3 swin = { points[i].x, points[i].y, 0 };
+        GLKVector3 ewin = { points[i].x, points[i].y, 1 };
+        
+        bool startValid, endValid;
+        starts[i] = GLKMathUnproject ( swin, modelViewMatrix, self.camera.projectionMatrix, viewport, &startValid );
+        ends[i] = GLKMathUnproject ( ewin, modelViewMatrix, self.camera.projectionMatrix, viewport, &endValid );
+        ellipsoidHits[i] = NO;
+        terrainHits[i] = NO;
         
-    bool startValid, endValid;
-    GLKVector3 start = GLKMathUnproject ( swin, modelViewMatrix, self.camera.projectionMatrix, viewport, &startValid );
-    GLKVector3 end = GLKMathUnproject ( ewin, modelViewMatrix, self.camera.projectionMatrix, viewport, &endValid );
-    
-    if ( startValid && endValid ) {
-        // find intersection
-        GLKVector3 position;
-        if ( IntersectWithEllipsoid( start, end, &position ) ) {
-            RAPolarCoordinate coord = ConvertEcefToPolar(position);
-            if ( lat ) *lat = coord.latitude;
-            if ( lon ) *lon = coord.longitude;
-            return YES;
+        if ( ! ( startValid && endValid ) ) {
+            // an empty segment hits nothing
+            ends[i] = starts[i];
+        } else {
+            ellipsoidHits[i] = IntersectWithEllipsoid( starts[i], ends[i], &positions[i] );
+            
+            // terrain can lie below the ellipsoid, so the search for it ends at a copy shrunk past the
+            // deepest terrain; scaling by the polar radius shrinks the equator slightly further
+            float scale = 1.0f + self.pager.minimumTerrainHeight / kRadiusPolar;
+            GLKVector3 deepest;
+            if ( IntersectWithEllipsoid( GLKVector3DivideScalar(starts[i], scale), GLKVector3DivideScalar(ends[i], scale), &deepest ) ) {
+                ends[i] = GLKVector3MultiplyScalar(deepest, scale);
+            }
         }
     }
     
-    return NO;
-}
-
-- (void)updateCamera {
-    // !!! how do we collalesce calls to this?
-    self.camera.modelViewMatrix = [self modelViewMatrixForState:_state];
+    // refine against the loaded terrain, which also catches peaks above the horizon
+    [self.pager intersectTerrainWithSegments:count from:starts to:ends hits:positions found:terrainHits];
+    
+    NSUInteger hitCount = 0;
+    for( NSUInteger i = 0; i < count; i++ ) {
+        BOOL isHit = ( ellipsoidHits[i] || terrainHits[i] );
+        if ( isHit ) {
+            RAPolarCoordinate coord = ConvertEcefToPolar(positions[i]);
+            if ( lats ) lats[i] = coord.latitude;
+            if ( lons ) lons[i] = coord.longitude;
+            hitCount++;
+        }
+        if ( hits ) hits[i] = isHit;
+    }
+    
+    return hitCount;
 }
 
 - (BOOL)gestureRecognizer:(UIGestureRecognizer *)gestureRecognizer shouldRecognizeSimultaneouslyWithGestureRecognizer:(UIGestureRecognizer *)otherGestureRecognizer
@@ -258,12 +441,7 @@ typedef enum {
             CGFloat distance = _state.distance / pinch.velocity;
             if ( fabs(distance) < _state.distance / 10. ) break;
             
-            TPPropertyAnimation *anim = [TPPropertyAnimation propertyAnimationWithKeyPath:@"distance"];
-            anim.duration = kAnimationDuration;
-            anim.fromValue = [NSNumber numberWithDouble:_state.distance];
-            anim.toValue = [NSNumber numberWithDouble:_state.distance - distance];
-            anim.timing = TPPropertyAnimationTimingEaseOut;
-            [anim beginWithTarget:self];
+            [self animateField:RACameraDistance to:_state.distance - distance duration:kAnimationDuration timing:RAAnimationTimingEaseOut];
             */
             break;
         }
@@ -340,8 +518,10 @@ typedef enum {
                     double lat, lon;
                     if ( [self intersectPoint:pt atLatitude:&lat atLongitude:&lon withState:_state] ) {
                         // rotate the globe so cursor is under the touch again
+                        [self beginUpdates];
                         self.latitude -= lat - cursorLatitude;
                         self.longitude -= lon - cursorLongitude;
+                        [self endUpdates];
                         
                         //NSLog(@"lat = %f, lon = %f", _state.latitude, _state.longitude);
                     }
@@ -373,12 +553,7 @@ typedef enum {
                     // calculate how much movement
                     double angle = vel.x * 0.03;
 
-                    TPPropertyAnimation *anim = [TPPropertyAnimation propertyAnimationWithKeyPath:@"azimuth"];
-                    anim.duration = kAnimationDuration;
-                    anim.fromValue = [NSNumber numberWithDouble:_state.azimuth];
-                    anim.toValue = [NSNumber numberWithDouble:_state.azimuth + angle];
-                    anim.timing = TPPropertyAnimationTimingEaseOut;
-                    [anim beginWithTarget:self];
+                    [self animateField:RACameraAzimuth to:_state.azimuth + angle duration:kAnimationDuration timing:RAAnimationTimingEaseOut];
                     
                     break;
                 }
@@ -387,12 +562,7 @@ typedef enum {
                     // calculate how much movement
                     double angle = vel.y * 0.03;
                     
-                    TPPropertyAnimation *anim = [TPPropertyAnimation propertyAnimationWithKeyPath:@"elevation"];
-                    anim.duration = kAnimationDuration;
-                    anim.fromValue = [NSNumber numberWithDouble:_state.elevation];
-                    anim.toValue = [NSNumber numberWithDouble:_state.elevation + angle];
-                    anim.timing = TPPropertyAnimationTimingEaseOut;
-                    [anim beginWithTarget:self];
+                    [self animateField:RACameraElevation to:_state.elevation + angle duration:kAnimationDuration timing:RAAnimationTimingEaseOut];
                     
                     break;
                 }
@@ -415,19 +585,8 @@ typedef enum {
                     double dest_lat = _state.latitude + dir_lat*angle;
                     
                     // zoom to that location
-                    TPPropertyAnimation *anim = [TPPropertyAnimation propertyAnimationWithKeyPath:@"latitude"];
-                    anim.duration = kAnimationDuration;
-                    anim.fromValue = [NSNumber numberWithDouble:_state.latitude];
-                    anim.toValue = [NSNumber numberWithDouble:dest_lat];
-                    anim.timing = TPPropertyAnimationTimingEaseOut;
-                    [anim beginWithTarget:self];
-                    
-                    anim = [TPPropertyAnimation propertyAnimationWithKeyPath:@"longitude"];
-                    anim.duration = kAnimationDuration;
-                    anim.fromValue = [NSNumber numberWithDouble:_state.longitude];
-                    anim.toValue = [NSNumber numberWithDouble:dest_lon];
-                    anim.timing = TPPropertyAnimationTimingEaseOut;
-                    [anim beginWithTarget:self];
+                    [self animateField:RACameraLatitude to:dest_lat duration:kAnimationDuration timing:RAAnimationTimingEaseOut];
+                    [self animateField:RACameraLongitude to:dest_lon duration:kAnimationDuration timing:RAAnimationTimingEaseOut];
                     
                     break;
                 }
@@ -440,12 +599,7 @@ typedef enum {
                     double destination = _state.longitude + angle;
                     
                     // spin the globe
-                    TPPropertyAnimation *anim = [TPPropertyAnimation propertyAnimationWithKeyPath:@"longitude"];
-                    anim.duration = kAnimationDuration * 2.0;
-                    anim.fromValue = [NSNumber numberWithDouble:_state.longitude];
-                    anim.toValue = [NSNumber numberWithDouble:destination];
-                    anim.timing = TPPropertyAnimationTimingEaseOut;
-                    [anim beginWithTarget:self];
+                    [self animateField:RACameraLongitude to:destination duration:kAnimationDuration * 2.0 timing:RAAnimationTimingEaseOut];
                     
                     break;
                 }
@@ -460,7 +614,7 @@ typedef enum {
 
 - (void)stop:(id)sender {
     // cancel animations in progress
-    [[TPPropertyAnimation allPropertyAnimationsForTarget:self] makeObjectsPerformSelector:@selector(cancel)];
+    [self stopAnimations];
 
     //printf("Stop\n");
 }
@@ -481,57 +635,29 @@ typedef enum {
     const double duration = 1.0;
 
     // zoom in to that location
-    TPPropertyAnimation *anim = [TPPropertyAnimation propertyAnimationWithKeyPath:@"latitude"];
-    anim.duration = duration;
-    anim.fromValue = [NSNumber numberWithDouble:_state.latitude];
-    anim.toValue = [NSNumber numberWithDouble:lat];
-    anim.timing = TPPropertyAnimationTimingEaseInEaseOut;
-    [anim beginWithTarget:self];
-
-    anim = [TPPropertyAnimation propertyAnimationWithKeyPath:@"longitude"];
-    anim.duration = duration;
-    anim.fromValue = [NSNumber numberWithDouble:_state.longitude];
-    anim.toValue = [NSNumber numberWithDouble:lon];
-    anim.timing = TPPropertyAnimationTimingEaseInEaseOut;
-    [anim beginWithTarget:self];
-
-    anim = [TPPropertyAnimation propertyAnimationWithKeyPath:@"distance"];
-    anim.duration = duration;
-    anim.fromValue = [NSNumber numberWithDouble:_state.distance];
-    anim.toValue = [NSNumber numberWithDouble:_state.distance / 2.0];
-    anim.timing = TPPropertyAnimationTimingEaseInEaseOut;
-    [anim beginWithTarget:self];
+    [self animateField:RACameraLatitude to:lat duration:duration timing:RAAnimationTimingEaseInEaseOut];
+    [self animateField:RACameraLongitude to:lon duration:duration timing:RAAnimationTimingEaseInEaseOut];
+    [self animateField:RACameraDistance to:_state.distance / 2.0 duration:duration timing:RAAnimationTimingEaseInEaseOut];
 }
 
 
 - (void)debugZoomInOut:(id)sender {
     double duration = 5.0;
+    double distance = _state.distance;
     [self stop: nil];
     
-    TPPropertyAnimation *anim1 = [TPPropertyAnimation propertyAnimationWithKeyPath:@"distance"];
-    anim1.target = self;
-    anim1.duration = duration;
-    anim1.fromValue = [NSNumber numberWithDouble:_state.distance];
-    anim1.toValue = [NSNumber numberWithDouble:2000];
-    anim1.timing = TPPropertyAnimationTimingEaseInEaseOut;
-
-    TPPropertyAnimation *anim2 = [TPPropertyAnimation propertyAnimationWithKeyPath:@"distance"];
-    anim2.target = self;
-    anim2.duration = duration;
-    anim2.fromValue = [NSNumber numberWithDouble:2000];
-    anim2.toValue = [NSNumber numberWithDouble:1000];
-    anim2.timing = TPPropertyAnimationTimingEaseInEaseOut;
-    
-    TPPropertyAnimation *anim3 = [TPPropertyAnimation propertyAnimationWithKeyPath:@"distance"];
-    anim3.target = self;
-    anim3.duration = duration;
-    anim3.fromValue = [NSNumber numberWithDouble:1000];
-    anim3.toValue = [NSNumber numberWithDouble:_state.distance];
-    anim3.timing = TPPropertyAnimationTimingEaseInEaseOut;
-
-    anim1.chainedAnimation = anim2;
-    anim2.chainedAnimation = anim3;
-    [anim1 beginWithTarget:self];
+    // each leg starts when the previous one ends, unless something stops them first
+    __block RAManipulator * mySelf = self;
+    NSUInteger epoch = _animationEpoch;
+    double legs[] = { 2000, 1000, distance };
+    
+    for( int leg = 0; leg < 3; leg++ ) {
+        double target = legs[leg];
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(leg * duration * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+            if ( mySelf->_animationEpoch != epoch ) return;
+            [mySelf animateField:RACameraDistance to:target duration:duration timing:RAAnimationTimingEaseInEaseOut];
+        });
+    }
 }
 
 @end
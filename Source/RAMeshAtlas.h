@@ -0,0 +1,51 @@
+//
+//  RAMeshAtlas.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/6/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "RAGeometry.h"
+#include "RABatchBuilder.h"
+
+@class RAMeshAtlas;
+
+// a mesh's place in a mesh atlas, given back when released
+@interface RAMeshAtlasSlot : NSObject
+
+@property (readonly) RAMeshAtlas * atlas;
+@property (readonly) uint32_t page;
+@property (readonly) uint32_t slot;
+
+@end
+
+
+// stores meshes sharing one vertex layout and index topology in a few large buffers,
+// so that many of them can be drawn with a single call
+@interface RAMeshAtlas : NSObject
+
+@property (readonly) NSUInteger vertexCount;    // per mesh
+@property (readonly) NSUInteger slotsPerPage;
+@property (readonly) NSUInteger pageCount;
+@property (readonly) NSUInteger meshCount;
+
+// the template supplies the layout and topology; it must use 16-bit indices
+- (id)initWithTemplate:(RAGeometry *)geometry;
+
+- (BOOL)isCompatibleWithGeometry:(RAGeometry *)geometry;
+
+// these methods must be called from within a context
+
+// copies the vertices into a free slot and sets the geometry's atlasSlot; NO if it doesn't fit
+- (BOOL)addGeometry:(RAGeometry *)geometry;
+
+// items must be sorted into the batches, as RABatchBuild leaves them
+// prepare is called before each draw to set uniforms and bind textures; returns the number of draws
+- (NSUInteger)drawBatches:(const RABatch *)batches count:(size_t)batchCount items:(const RABatchItem *)items count:(size_t)itemCount prepare:(void (^)(const RABatch * batch))prepare;
+
+- (void)tearDownGL;
+
+@end
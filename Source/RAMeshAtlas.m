@@ -0,0 +1,337 @@
+//
+//  RAMeshAtlas.m
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/6/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import "RAMeshAtlas.h"
+
+#import <OpenGLES/EAGL.h>
+#import <OpenGLES/ES2/gl.h>
+#import <OpenGLES/ES2/glext.h>
+
+#include "RASlotAllocator.h"
+
+#define kMaxVerticesPerPage (65536)     // addressable with 16-bit indices
+
+// what the batch draw needs to bind each batch's vertex page
+typedef struct {
+    __unsafe_unretained NSArray *   pages;
+    GLuint                          streamBuffer;
+    __unsafe_unretained void (^prepare)(const RABatch * batch);
+} DrawContext;
+
+
+@interface RAMeshAtlas (PrivateMethods)
+- (void)releaseSlot:(uint32_t)slot inPage:(uint32_t)page;
+@end
+
+
+@implementation RAMeshAtlasSlot
+
+@synthesize atlas = _atlas, page = _page, slot = _slot;
+
+- (id)initWithAtlas:(RAMeshAtlas *)atlas page:(uint32_t)page slot:(uint32_t)slot {
+    self = [super init];
+    if ( self ) {
+        _atlas = atlas;
+        _page = page;
+        _slot = slot;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [_atlas releaseSlot:_slot inPage:_page];
+}
+
+@end
+
+
+@interface RAMeshAtlasPage : NSObject {
+@public
+    RASlotAllocator     slots;
+    GLuint              vertexArray;
+    GLuint              vertexBuffer;
+}
+@end
+
+@implementation RAMeshAtlasPage
+
+- (void)dealloc {
+    RASlotAllocatorDestroy( &slots );
+}
+
+- (void)releaseGL {
+    if ( vertexBuffer ) glDeleteBuffers( 1, &vertexBuffer );
+    if ( vertexArray ) glDeleteVertexArraysOES( 1, &vertexArray );
+    vertexBuffer = vertexArray = 0;
+}
+
+@end
+
+
+static void PrepareBatch( const RABatch * batch, void * context )
+{
+    DrawContext * draw = (DrawContext *)context;
+    RAMeshAtlasPage * page = [draw->pages objectAtIndex:batch->page];
+    
+    if ( draw->prepare ) draw->prepare( batch );
+    
+    glBindVertexArrayOES( page->vertexArray );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, draw->streamBuffer );
+}
+
+
+@implementation RAMeshAtlas {
+    NSMutableArray *    _pages;
+    
+    // layout shared by every mesh
+    NSUInteger          _vertexStride;
+    NSUInteger          _vertexBytes;
+    NSInteger           _positionOffset;
+    NSInteger           _normalOffset;
+    NSInteger           _colorOffset;
+    NSInteger           _textureOffset;
+    NSInteger           _texture1Offset;
+    NSInteger           _texture2Offset;
+    GLenum              _elementStyle;
+    NSData *            _topology;
+    NSUInteger          _indexCount;
+    
+    // the topology rebased to each slot of a page
+    NSMutableData *     _slotIndices;
+    
+    // indices for the batches drawn last, rebuilt only when they change
+    GLuint              _streamBuffer;
+    NSMutableData *     _streamIndices;
+    NSMutableData *     _streamItems;
+}
+
+@synthesize vertexCount = _vertexCount, slotsPerPage = _slotsPerPage;
+
+- (id)initWithTemplate:(RAGeometry *)geometry {
+    RAMeshBuffer * vertices = geometry.objectBuffer;
+    RAMeshBuffer * indices = geometry.indexBuffer;
+    
+    if ( vertices == nil || indices == nil || geometry.objectStride == 0 || geometry.indexStride != sizeof(GLushort) ) return nil;
+    if ( vertices.length / geometry.objectStride > kMaxVerticesPerPage ) return nil;
+    
+    self = [super init];
+    if ( self ) {
+        _pages = [NSMutableArray array];
+        
+        _vertexStride = geometry.objectStride;
+        _vertexBytes = vertices.length;
+        _vertexCount = _vertexBytes / _vertexStride;
+        _positionOffset = geometry.positionOffset;
+        _normalOffset = geometry.normalOffset;
+        _colorOffset = geometry.colorOffset;
+        _textureOffset = geometry.textureOffset;
+        _texture1Offset = geometry.texture1Offset;
+        _texture2Offset = geometry.texture2Offset;
+        _elementStyle = geometry.elementStyle;
+        _topology = [NSData dataWithBytes:indices.bytes length:indices.length];
+        _indexCount = indices.length / sizeof(GLushort);
+        
+        _slotsPerPage = kMaxVerticesPerPage / _vertexCount;
+        
+        _slotIndices = [NSMutableData dataWithLength:( _slotsPerPage * _indexCount * sizeof(GLushort) )];
+        GLushort * slotIndices = (GLushort *)[_slotIndices mutableBytes];
+        const GLushort * topology = (const GLushort *)[_topology bytes];
+        for( NSUInteger slot = 0; slot < _slotsPerPage; slot++ ) {
+            GLushort base = slot * _vertexCount;
+            for( NSUInteger i = 0; i < _indexCount; i++ )
+                *slotIndices++ = base + topology[i];
+        }
+        
+        _streamIndices = [NSMutableData data];
+        _streamItems = [NSMutableData data];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    // the pager holds the atlas for the life of its context
+    if ( [EAGLContext currentContext] ) [self tearDownGL];
+}
+
+- (NSUInteger)pageCount {
+    @synchronized(self) {
+        return [_pages count];
+    }
+}
+
+- (NSUInteger)meshCount {
+    NSUInteger count = 0;
+    @synchronized(self) {
+        for( RAMeshAtlasPage * page in _pages ) count += page->slots.count;
+    }
+    return count;
+}
+
+- (BOOL)isCompatibleWithGeometry:(RAGeometry *)geometry {
+    RAMeshBuffer * vertices = geometry.objectBuffer;
+    RAMeshBuffer * indices = geometry.indexBuffer;
+    
+    if ( vertices.length != _vertexBytes || geometry.objectStride != _vertexStride ) return NO;
+    if ( geometry.positionOffset != _positionOffset || geometry.normalOffset != _normalOffset ||
+         geometry.colorOffset != _colorOffset || geometry.textureOffset != _textureOffset ) return NO;
+    if ( geometry.texture1Offset != _texture1Offset || geometry.texture2Offset != _texture2Offset ) return NO;
+    if ( geometry.elementStyle != _elementStyle || geometry.indexStride != sizeof(GLushort) ) return NO;
+    if ( indices.length != [_topology length] ) return NO;
+    
+    return memcmp( indices.bytes, [_topology bytes], indices.length ) == 0;
+}
+
+- (RAMeshAtlasPage *)createPage {
+    RAMeshAtlasPage * page = [RAMeshAtlasPage new];
+    if ( ! RASlotAllocatorInit( &page->slots, _slotsPerPage ) ) return nil;
+    
+    glGenVertexArraysOES( 1, &page->vertexArray );
+    glGenBuffers( 1, &page->vertexBuffer );
+    
+    glBindVertexArrayOES( page->vertexArray );
+    glBindBuffer( GL_ARRAY_BUFFER, page->vertexBuffer );
+    glBufferData( GL_ARRAY_BUFFER, _slotsPerPage * _vertexBytes, NULL, GL_STATIC_DRAW );
+    
+    // set attribute pointers
+    if ( _positionOffset >= 0 ) {
+        glEnableVertexAttribArray(GLKVertexAttribPosition);
+        glVertexAttribPointer(GLKVertexAttribPosition, 3, GL_FLOAT, GL_FALSE, _vertexStride, (const GLvoid *)_positionOffset);
+    }
+    
+    if ( _normalOffset >= 0 ) {
+        glEnableVertexAttribArray(GLKVertexAttribNormal);
+        glVertexAttribPointer(GLKVertexAttribNormal, 3, GL_FLOAT, GL_FALSE, _vertexStride, (const GLvoid *)_normalOffset);
+    }
+    
+    if ( _colorOffset >= 0 ) {
+        glEnableVertexAttribArray(GLKVertexAttribColor);
+        glVertexAttribPointer(GLKVertexAttribColor, 4, GL_FLOAT, GL_FALSE, _vertexStride, (const GLvoid *)_colorOffset);
+    }
+    
+    if ( _textureOffset >= 0 ) {
+        glEnableVertexAttribArray(GLKVertexAttribTexCoord0);
+        glVertexAttribPointer(GLKVertexAttribTexCoord0, 2, GL_FLOAT, GL_FALSE, _vertexStride, (const GLvoid *)_textureOffset);
+    }
+    
+    // overlay coordinates, textures are bound per batch
+    if ( _texture1Offset >= 0 ) {
+        glEnableVertexAttribArray(GLKVertexAttribTexCoord1);
+        glVertexAttribPointer(GLKVertexAttribTexCoord1, 2, GL_FLOAT, GL_FALSE, _vertexStride, (const GLvoid *)_texture1Offset);
+    }
+    
+    if ( _texture2Offset >= 0 ) {
+        glEnableVertexAttribArray(RAVertexAttribTexCoord2);
+        glVertexAttribPointer(RAVertexAttribTexCoord2, 2, GL_FLOAT, GL_FALSE, _vertexStride, (const GLvoid *)_texture2Offset);
+    }
+    
+    glBindVertexArrayOES(0);
+    return page;
+}
+
+- (BOOL)addGeometry:(RAGeometry *)geometry {
+    NSAssert( [EAGLContext currentContext], @"must be called with an active context" );
+    
+    if ( ! [self isCompatibleWithGeometry:geometry] ) return NO;
+    
+    RAMeshAtlasPage * page = nil;
+    uint32_t pageIndex = 0;
+    int slot = -1;
+    
+    @synchronized(self) {
+        // fill the earliest pages first, so later ones can drain
+        for( RAMeshAtlasPage * candidate in _pages ) {
+            @synchronized(candidate) {
+                slot = RASlotAllocatorAcquire( &candidate->slots );
+            }
+            if ( slot >= 0 ) {
+                page = candidate;
+                break;
+            }
+            pageIndex++;
+        }
+        
+        if ( page == nil ) {
+            page = [self createPage];
+            if ( page == nil ) return NO;
+            
+            [_pages addObject:page];
+            slot = RASlotAllocatorAcquire( &page->slots );
+        }
+    }
+    
+    glBindBuffer( GL_ARRAY_BUFFER, page->vertexBuffer );
+    glBufferSubData( GL_ARRAY_BUFFER, slot * _vertexBytes, _vertexBytes, geometry.objectBuffer.bytes );
+    
+    GLenum err = glGetError();
+    if ( err != GL_NO_ERROR )
+        NSLog(@"-[RAMeshAtlas addGeometry:]: glGetError = %d", err);
+    
+    geometry.atlasSlot = [[RAMeshAtlasSlot alloc] initWithAtlas:self page:pageIndex slot:slot];
+    return YES;
+}
+
+- (void)releaseSlot:(uint32_t)slot inPage:(uint32_t)pageIndex {
+    // geometry can be released on any thread; the stale vertices are simply never drawn
+    RAMeshAtlasPage * page = nil;
+    @synchronized(self) {
+        page = [_pages objectAtIndex:pageIndex];
+    }
+    @synchronized(page) {
+        RASlotAllocatorRelease( &page->slots, slot );
+    }
+}
+
+- (NSUInteger)drawBatches:(const RABatch *)batches count:(size_t)batchCount items:(const RABatchItem *)items count:(size_t)itemCount prepare:(void (^)(const RABatch * batch))prepare {
+    NSAssert( [EAGLContext currentContext], @"must be called with an active context" );
+    
+    if ( batchCount == 0 ) return 0;
+    
+    if ( _streamBuffer == 0 ) glGenBuffers( 1, &_streamBuffer );
+    
+    // while the view holds still the sorted items repeat, and so do the indices
+    size_t itemBytes = itemCount * sizeof(RABatchItem);
+    if ( itemBytes != [_streamItems length] || memcmp( items, [_streamItems bytes], itemBytes ) != 0 ) {
+        size_t meshIndexBytes = _indexCount * sizeof(GLushort);
+        [_streamIndices setLength:( itemCount * meshIndexBytes )];
+        
+        uint8_t * stream = (uint8_t *)[_streamIndices mutableBytes];
+        const uint8_t * slotIndices = (const uint8_t *)[_slotIndices bytes];
+        for( size_t i = 0; i < itemCount; i++ )
+            memcpy( stream + i * meshIndexBytes, slotIndices + items[i].slot * meshIndexBytes, meshIndexBytes );
+        
+        [_streamItems setLength:0];
+        [_streamItems appendBytes:items length:itemBytes];
+        
+        glBindVertexArrayOES(0);
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, _streamBuffer );
+        glBufferData( GL_ELEMENT_ARRAY_BUFFER, [_streamIndices length], [_streamIndices bytes], GL_STREAM_DRAW );
+    }
+    
+    NSArray * pages = nil;
+    @synchronized(self) {
+        pages = [_pages copy];
+    }
+    
+    DrawContext context = { pages, _streamBuffer, prepare };
+    NSUInteger draws = RABatchDraw( batches, batchCount, _indexCount, _elementStyle, PrepareBatch, &context );
+    
+    glBindVertexArrayOES(0);
+    return draws;
+}
+
+- (void)tearDownGL {
+    @synchronized(self) {
+        for( RAMeshAtlasPage * page in _pages ) [page releaseGL];
+    }
+    
+    if ( _streamBuffer ) glDeleteBuffers( 1, &_streamBuffer );
+    _streamBuffer = 0;
+    [_streamItems setLength:0];
+}
+
+@end
@@ -8,17 +8,27 @@
 
 #import <Foundation/Foundation.h>
 
-@class RABoundingSphere;
+#import "RABoundingSphere.h"
+
 @class RANodeVisitor;
+@class RACompiledGraph;
 
 
 @interface RANode : NSObject {
-    __weak RANode *     _parent;
-    RABoundingSphere *  _bound;
+    __weak RANode *             _parent;
+    RABoundingSphere            _bound;
+    BOOL                        _boundDirty;
+    
+    __weak RACompiledGraph *    _graph;
+    NSInteger                   _graphIndex;
 }
 
 @property (weak, atomic) RANode * parent;
-@property (retain, atomic) RABoundingSphere * bound;
+@property (assign, atomic) RABoundingSphere bound;
+
+// set when the node is compiled into a graph
+@property (weak, atomic) RACompiledGraph * graph;
+@property (assign, atomic) NSInteger graphIndex;
 
 - (SEL)visitorSelector;
 - (void)accept:(RANodeVisitor *)visitor;
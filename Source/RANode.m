@@ -8,11 +8,25 @@
 
 #import "RANode.h"
 #import "RANodeVisitor.h"
+#import "RACompiledGraph.h"
 
 @implementation RANode
 
 @synthesize parent = _parent;
 @synthesize bound = _bound;
+@synthesize graph = _graph;
+@synthesize graphIndex = _graphIndex;
+
+- (id)init
+{
+    self = [super init];
+    if ( self ) {
+        _graphIndex = -1;
+        _bound = RABoundingSphereInvalid;
+        _boundDirty = YES;
+    }
+    return self;
+}
 
 - (SEL)visitorSelector
 {
@@ -39,27 +53,38 @@
 {
 }
 
-- (RABoundingSphere *)bound
+- (RABoundingSphere)bound
 {
-    if ( _bound == nil ) [self calculateBound];
-    return _bound;
+    @synchronized(self) {
+        if ( _boundDirty ) {
+            _boundDirty = NO;
+            [self calculateBound];
+        }
+        return _bound;
+    }
 }
 
-- (void)setBound:(RABoundingSphere *)newBound
+- (void)setBound:(RABoundingSphere)newBound
 {
-    _bound = newBound;
+    @synchronized(self) {
+        _bound = newBound;
+        _boundDirty = NO;
+    }
     [_parent calculateBound];
 }
 
 - (void)dirtyBound
 {
-    _bound = nil;
+    @synchronized(self) {
+        _bound = RABoundingSphereInvalid;
+        _boundDirty = YES;
+    }
     [_parent dirtyBound];
 }
 
 - (void)calculateBound
 {
-    // overload in subclasses, but do not set bound property
+    // overload in subclasses to assign _bound, but do not set bound property
 }
 
 @end
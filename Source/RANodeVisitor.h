@@ -14,6 +14,7 @@
 #import "RATransform.h"
 #import "RAGeometry.h"
 #import "RAPageNode.h"
+#import "RACompiledGraph.h"
 
 
 @interface RANodeVisitor : NSObject {
@@ -26,6 +27,14 @@
 
 - (GLKMatrix4)currentTransform;
 
+// visits the geometry and page node leaves of an updated graph in order, using the cached
+// world transforms; groups and transforms are not visited individually, but a culled entry
+// skips its whole subtree
+- (void)traverseCompiledGraph:(RACompiledGraph *)graph;
+
+// overload to reject subtrees by their cached world bound, the default keeps everything
+- (BOOL)isBoundCulled:(RABoundingSphere)worldBound;
+
 - (void)applyNode:(RANode *)node;
 - (void)applyGroup:(RAGroup *)node;
 - (void)applyTransform:(RATransform *)node;
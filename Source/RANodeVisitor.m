@@ -50,6 +50,43 @@
     return GLKMatrixStackGetMatrix4(stack);
 }
 
+- (void)traverseCompiledGraph:(RACompiledGraph *)graph
+{
+    const RACompiledNode * nodes = [graph nodes];
+    NSUInteger count = [graph count];
+    
+    GLKMatrixStackPush(stack);
+    
+    for( NSUInteger i = 0; i < count; i++ ) {
+        const RACompiledNode * entry = &nodes[i];
+        
+        if ( RABoundingSphereIsValid(entry->worldBound) && [self isBoundCulled:entry->worldBound] ) {
+            i = entry->subtreeEnd - 1;
+            continue;
+        }
+        
+        switch( entry->kind ) {
+            case RACompiledKindGeometry:
+                GLKMatrixStackLoadMatrix4(stack, entry->worldTransform);
+                [self applyGeometry:(RAGeometry *)entry->node];
+                break;
+            case RACompiledKindPageNode:
+                GLKMatrixStackLoadMatrix4(stack, entry->worldTransform);
+                [self applyPageNode:(RAPageNode *)entry->node];
+                break;
+            default:
+                break;
+        }
+    }
+    
+    GLKMatrixStackPop(stack);
+}
+
+- (BOOL)isBoundCulled:(RABoundingSphere)worldBound
+{
+    return NO;
+}
+
 - (void)applyNode:(RANode *)node
 {
     [node traverse: self];
@@ -13,21 +13,36 @@
 #import "RAGeometry.h"
 #import "RACamera.h"
 #import "RATileDatabase.h"
+#import "RAHeightField.h"
+#import "RATerrainTile.h"
+#import "RAImageryLayer.h"
+
+@class RAPageNode;
 
 typedef enum {
     NotLoaded = 0,
     Loading,
     Complete,
     Failed,
-    NeedsUpdate
+    NeedsUpdate,
+    Uploading       // built, waiting for a frame to upload it
 } RAPageLoadState;
 
+extern const float kRADefaultErrorThreshold;     // texels of screen-space error before a page is refined
+
 
 @interface RAPage : NSObject
 
 @property (readonly, nonatomic) TileID tile;
 @property (readonly, strong, nonatomic) NSString * key;
-@property (readonly, strong, nonatomic) RABoundingSphere * bound;
+@property (assign, atomic) RABoundingSphere bound;
+
+// the scene node showing this page, if any, is invalidated whenever the bound changes
+@property (weak, atomic) RAPageNode * node;
+
+// extrusion range covered by the bound, in ecef units relative to the ellipsoid
+@property (assign, nonatomic) float minHeight;
+@property (assign, nonatomic) float maxHeight;
 
 @property (readonly, weak, nonatomic) RAPage * parent;
 @property (strong, nonatomic) RAPage * child1;
@@ -43,19 +58,30 @@ typedef enum {
 @property (assign, nonatomic) RAPageLoadState imageryState;
 @property (strong, nonatomic) RATextureWrapper * imagery;
 
+// imagery by layer of the pager's stack; layer 0 is the base imagery above, the overlays follow
+- (RAPageLoadState)imageryStateForLayer:(NSUInteger)layer;
+- (void)setImageryState:(RAPageLoadState)state forLayer:(NSUInteger)layer;
+- (RATextureWrapper *)imageryForLayer:(NSUInteger)layer;
+- (void)setImagery:(RATextureWrapper *)texture forLayer:(NSUInteger)layer;
+
 @property (assign, nonatomic) RAPageLoadState terrainState;
-@property (strong, nonatomic) UIImage * terrain;
+@property (strong, nonatomic) RATerrainTile * terrain;
+
+// surface of the current mesh for picking, set whenever it is built from terrain
+@property (strong, atomic) RAHeightField * heightField;
 
 + (NSUInteger)count;
 
 - (RAPage *)initWithTileID:(TileID)t andParent:(RAPage *)parent;
 
-- (void)setCenter:(GLKVector3)center andRadius:(double)radius;
-
 - (float)calculateTiltWithCamera:(RACamera *)camera;
 - (float)calculateScreenSpaceErrorWithCamera:(RACamera *)camera;
 - (BOOL)isOnscreenWithCamera:(RACamera *)camera;
 
+// the same measures for a bound on its own, without making a page for it
++ (float)tiltOfBound:(RABoundingSphere)bound withCamera:(RACamera *)camera;
++ (float)screenSpaceErrorOfBound:(RABoundingSphere)bound withCamera:(RACamera *)camera;
+
 - (BOOL)isReady;
 
 @end
@@ -8,21 +8,33 @@
 
 #import "RAPage.h"
 
-static NSUInteger sTotalPageCount = 0;
+#import <libkern/OSAtomic.h>
+
+#import "RAPageNode.h"
+#import "RACompiledGraph.h"
+
+const float kRADefaultErrorThreshold = 5.0f;
+
+static int64_t sTotalPageCount = 0;     // pages are made and freed on several threads
 
 @implementation RAPage {
-    RABoundingSphere *  _bound;
     __weak RAPage *     _parent;
+    RABoundingSphere    bound;
+    
+    RAPageLoadState     _overlayState[kRAMaxImageryOverlays];
+    RATextureWrapper *  _overlayImagery[kRAMaxImageryOverlays];
 }
 
 @synthesize tile, key;
-@synthesize bound = _bound;
+@synthesize minHeight, maxHeight;
+@synthesize node;
 @synthesize parent = _parent, child1, child2, child3, child4;
 @synthesize lastRequestedTimestamp;
 @synthesize geometryState, geometry, imageryState, imagery, terrainState, terrain;
+@synthesize heightField;
 
 + (NSUInteger)count {
-    return sTotalPageCount;
+    return (NSUInteger)sTotalPageCount;
 }
 
 - (RAPage *)initWithTileID:(TileID)t andParent:(RAPage *)parent;
@@ -30,68 +42,119 @@ static NSUInteger sTotalPageCount = 0;
     self = [super init];
     if (self) {
         tile = t;
-        key = [NSString stringWithFormat:@"{%d,%d,%d}", t.z, t.x, t.y];
+        key = [NSString stringWithFormat:@"{%lu,%lu,%lu}", (unsigned long)t.z, (unsigned long)t.x, (unsigned long)t.y];
+        bound = RABoundingSphereInvalid;
         _parent = parent;
-        sTotalPageCount++;
+        OSAtomicIncrement64( &sTotalPageCount );
         
         geometryState = NotLoaded;
         imageryState = NotLoaded;
         terrainState = NotLoaded;
+        
+        for( int i = 0; i < kRAMaxImageryOverlays; i++ ) _overlayState[i] = NotLoaded;
     }
     return self;
 }
 
 - (void)dealloc {
-    sTotalPageCount--;
+    OSAtomicDecrement64( &sTotalPageCount );
 }
 
-- (void)setCenter:(GLKVector3)center andRadius:(double)radius {
-    _bound = [RABoundingSphere new];
-    _bound.center = center;
-    _bound.radius = radius;
+- (RABoundingSphere)bound {
+    @synchronized(self) {
+        return bound;
+    }
 }
 
-- (float)calculateTiltWithCamera:(RACamera *)camera {
+- (void)setBound:(RABoundingSphere)newBound {
+    @synchronized(self) {
+        bound = newBound;
+    }
+    
+    // the node caches this bound, and the compiled graph caches the node's; both are
+    // read by the main thread's traversal, so they only change there, like geometry swaps
+    __weak RAPageNode * weakNode = self.node;
+    void (^invalidate)(void) = ^{
+        RAPageNode * pageNode = weakNode;
+        [pageNode dirtyBound];
+        [pageNode.graph invalidateNode:pageNode];
+    };
+    
+    if ( [NSThread isMainThread] ) invalidate();
+    else [[NSOperationQueue mainQueue] addOperationWithBlock:invalidate];
+}
+
++ (float)tiltOfBound:(RABoundingSphere)bound withCamera:(RACamera *)camera {
     // calculate dot product between page normal and camera vector
     const GLKVector3 unitZ = { 0, 0, -1 };
-    GLKVector3 pageNormal = GLKVector3Normalize(self.bound.center);
+    GLKVector3 pageNormal = GLKVector3Normalize(bound.center);
     GLKVector3 cameraLook = GLKVector3Normalize(GLKMatrix4MultiplyAndProjectVector3( GLKMatrix4Invert(camera.modelViewMatrix, NULL), unitZ ));
     return GLKVector3DotProduct(pageNormal, cameraLook);
 }
 
+- (float)calculateTiltWithCamera:(RACamera *)camera {
+    return [RAPage tiltOfBound:self.bound withCamera:camera];
+}
+
 - (float)calculateScreenSpaceErrorWithCamera:(RACamera *)camera {
-    GLKVector3 center = GLKMatrix4MultiplyAndProjectVector3( camera.modelViewMatrix, self.bound.center );
+    return [RAPage screenSpaceErrorOfBound:self.bound withCamera:camera];
+}
+
++ (float)screenSpaceErrorOfBound:(RABoundingSphere)b withCamera:(RACamera *)camera {
+    GLKVector3 center = GLKMatrix4MultiplyAndProjectVector3( camera.modelViewMatrix, b.center );
     double distance = GLKVector3Length(center);
     
     // convert object error to screen error
     CGSize size = camera.viewport.size;
-    float epsilon = ( 2. * self.bound.radius ) / 256.;    // object error
+    float epsilon = ( 2. * b.radius ) / 256.;    // object error
     float x = MAX(size.width, size.height) * [[UIScreen mainScreen] scale];    // screen size
     float w = 2. * distance * camera.tanThetaOverTwo;
     return ( epsilon * x ) / w;
 }
 
 - (BOOL)isOnscreenWithCamera:(RACamera *)camera {
-    // convert the bounding sphere center into camera space
-    GLKVector3 s = GLKMatrix4MultiplyAndProjectVector3( camera.modelViewMatrix, self.bound.center );
+    // the bound covers the terrain, so no extra margin is needed
+    return [camera isBoundOnscreen:self.bound];
+}
+
+- (RAPageLoadState)imageryStateForLayer:(NSUInteger)layer {
+    if ( layer == 0 ) return imageryState;
     
-    float radius = self.bound.radius * 1.5f;
+    NSAssert( layer <= kRAMaxImageryOverlays, @"too many imagery layers" );
+    return _overlayState[layer-1];
+}
 
-    // test against near/far planes
-    if ( s.z - radius > -camera.near ) return NO;
-    if ( s.z + radius < -camera.far ) return NO;
+- (void)setImageryState:(RAPageLoadState)state forLayer:(NSUInteger)layer {
+    if ( layer == 0 ) {
+        imageryState = state;
+        return;
+    }
+    
+    NSAssert( layer <= kRAMaxImageryOverlays, @"too many imagery layers" );
+    _overlayState[layer-1] = state;
+}
+
+- (RATextureWrapper *)imageryForLayer:(NSUInteger)layer {
+    if ( layer == 0 ) return imagery;
+    
+    NSAssert( layer <= kRAMaxImageryOverlays, @"too many imagery layers" );
+    return _overlayImagery[layer-1];
+}
 
-    // left, right, top, bottom planes
-    if ( GLKVector3DotProduct( camera.leftPlaneNormal, s ) > radius ) return NO;
-    if ( GLKVector3DotProduct( camera.rightPlaneNormal, s ) > radius ) return NO;
-    if ( GLKVector3DotProduct( camera.topPlaneNormal, s ) > radius ) return NO;
-    if ( GLKVector3DotProduct( camera.bottomPlaneNormal, s ) > radius ) return NO;
+- (void)setImagery:(RATextureWrapper *)texture forLayer:(NSUInteger)layer {
+    if ( layer == 0 ) {
+        imagery = texture;
+        return;
+    }
     
-    return YES;
+    NSAssert( layer <= kRAMaxImageryOverlays, @"too many imagery layers" );
+    _overlayImagery[layer-1] = texture;
 }
 
 - (BOOL)isReady {
-    return ( geometryState == Complete ) || ( geometryState == NeedsUpdate );
+    // a rebuilt page keeps drawing its previous geometry until the new one is uploaded
+    if ( geometry == nil ) return NO;
+    return ( geometryState == Complete ) || ( geometryState == NeedsUpdate ) || ( geometryState == Uploading );
 }
 
 @end
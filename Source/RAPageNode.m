@@ -8,6 +8,8 @@
 
 #import "RAPageNode.h"
 
+#import "RACompiledGraph.h"
+
 @implementation RAPageNode
 
 @synthesize page = _page;
@@ -26,8 +28,11 @@
 }
 
 - (void)setPage:(RAPage *)page {
+    if ( _page.node == self ) _page.node = nil;
     _page = page;
+    _page.node = self;
     [self dirtyBound];
+    [_graph invalidateNode:self];
 }
 
 @end
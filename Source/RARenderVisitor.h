@@ -17,9 +17,11 @@
 @property (readonly) NSString * statsString;
 
 @property (strong) RACamera * camera;
+@property (assign) float errorThreshold;    // default: kRADefaultErrorThreshold, match the pager's for this camera
 @property (assign) GLKVector3 lightPosition;
 @property (assign) GLKVector4 lightAmbientColor;
 @property (assign) GLKVector4 lightDiffuseColor;
+@property (assign) GLKVector4 overlayOpacity;      // per imagery overlay in the pager's order, 0 skips it
 
 - (void)clear;
 - (void)sortBackToFront;
@@ -12,8 +12,13 @@
 #import <GLKit/GLKMatrix4.h>
 #import <GLKit/GLKMathUtils.h>
 
+#import <OpenGLES/ES2/gl.h>
+
 #import "RABoundingSphere.h"
 #import "RAShaderProgram.h"
+#import "RAMeshAtlas.h"
+
+#define kMaxBatchTransforms (8)     // distinct model matrices batched per frame
 
 // Uniform index.
 enum
@@ -22,6 +27,8 @@ enum
 //    UNIFORM_NORMAL_MATRIX,
     UNIFORM_TEXTURE0,
     UNIFORM_TEXTURE1,
+    UNIFORM_TEXTURE2,
+    UNIFORM_OVERLAY_OPACITY,
     UNIFORM_LIGHT_DIRECTION,
     UNIFORM_LIGHT_AMBIENT_COLOR,
     UNIFORM_LIGHT_DIFFUSE_COLOR,
@@ -60,11 +67,13 @@ enum
 @implementation RARenderVisitor {
     NSMutableArray *    renderQueue;
     RAShaderProgram *   shader;
-    
+    NSUInteger          drawCount;
 }
 
 @synthesize camera;
+@synthesize errorThreshold = _errorThreshold;
 @synthesize lightPosition = _lightPosition, lightAmbientColor = _lightAmbientColor, lightDiffuseColor = _lightDiffuseColor;
+@synthesize overlayOpacity = _overlayOpacity;
 
 - (id)init
 {
@@ -74,10 +83,12 @@ enum
         shader = [[RAShaderProgram alloc] init];
         
         self.camera = [RACamera new];
+        self.errorThreshold = kRADefaultErrorThreshold;
         
         self.lightPosition = GLKVector3Make(1.0, 1.0, 1.0);
         self.lightAmbientColor = GLKVector4Make(0.1, 0.1, 0.1, 1.0);
         self.lightDiffuseColor = GLKVector4Make(0.9, 0.9, 0.9, 1.0);
+        self.overlayOpacity = GLKVector4Make(0, 0, 0, 0);
     }
     return self;
 }
@@ -96,7 +107,7 @@ enum
 
 - (NSString *)statsString
 {
-    return [NSString stringWithFormat:@"%d geometries", [renderQueue count]];
+    return [NSString stringWithFormat:@"%lu geometries, %lu draws", (unsigned long)[renderQueue count], (unsigned long)drawCount];
 }
 
 - (void)setupGL
@@ -105,6 +116,8 @@ enum
         [shader bindAttribute:@"position" toIdentifier:GLKVertexAttribPosition];
         [shader bindAttribute:@"normal" toIdentifier:GLKVertexAttribNormal];
         [shader bindAttribute:@"textureCoordinate" toIdentifier:GLKVertexAttribTexCoord0];
+        [shader bindAttribute:@"textureCoordinate1" toIdentifier:GLKVertexAttribTexCoord1];
+        [shader bindAttribute:@"textureCoordinate2" toIdentifier:RAVertexAttribTexCoord2];
 
         [shader link];
         
@@ -113,6 +126,9 @@ enum
         [shader bindUniform:@"lightAmbientColor" toIdentifier:UNIFORM_LIGHT_AMBIENT_COLOR];
         [shader bindUniform:@"lightDiffuseColor" toIdentifier:UNIFORM_LIGHT_DIFFUSE_COLOR];
         [shader bindUniform:@"texture0" toIdentifier:UNIFORM_TEXTURE0];
+        [shader bindUniform:@"texture1" toIdentifier:UNIFORM_TEXTURE1];
+        [shader bindUniform:@"texture2" toIdentifier:UNIFORM_TEXTURE2];
+        [shader bindUniform:@"overlayOpacity" toIdentifier:UNIFORM_OVERLAY_OPACITY];
     }
 }
 
@@ -136,15 +152,84 @@ enum
     [shader setUniform:UNIFORM_LIGHT_DIFFUSE_COLOR toVector4:self.lightDiffuseColor];
     
     [shader setUniform:UNIFORM_TEXTURE0 toInt:0];
+    [shader setUniform:UNIFORM_TEXTURE1 toInt:1];
+    [shader setUniform:UNIFORM_TEXTURE2 toInt:2];
+    
+    // every layer is composited in the same draw, so the overlays add fetches rather than draws
+    [shader setUniform:UNIFORM_OVERLAY_OPACITY toVector4:self.overlayOpacity];
+    
+    drawCount = 0;
+    
+    // meshes stored in an atlas are drawn together, a batch per transform, textures and page
+    NSUInteger queueCount = [renderQueue count];
+    RABatchItem * items = (RABatchItem *)malloc( queueCount * sizeof(RABatchItem) );
+    RABatch * batches = (RABatch *)malloc( queueCount * sizeof(RABatch) );
+    GLKMatrix4 * transforms = (GLKMatrix4 *)malloc( kMaxBatchTransforms * sizeof(GLKMatrix4) );
+    __block size_t itemCount = 0;
+    __block uint32_t transformCount = 0;
+    __block RAMeshAtlas * atlas = nil;
+    GLKMatrix4 viewProjectionMatrix = GLKMatrix4Multiply( self.camera.projectionMatrix, self.camera.modelViewMatrix );
+    
+    void (^drawQueuedBatches)(void) = ^{
+        if ( itemCount == 0 ) return;
+        
+        size_t batchCount = RABatchBuild( items, itemCount, batches );
+        drawCount += [atlas drawBatches:batches count:batchCount items:items count:itemCount prepare:^(const RABatch * batch) {
+            [shader setUniform:UNIFORM_MODELVIEWPROJECTION_MATRIX toMatrix4:GLKMatrix4Multiply( viewProjectionMatrix, transforms[batch->transform] )];
+            
+            for( int unit = 0; unit < kRABatchTextureUnits; unit++ ) {
+                glActiveTexture(GL_TEXTURE0 + unit);
+                glBindTexture(GL_TEXTURE_2D, batch->textures[unit]);
+            }
+        }];
+        
+        itemCount = 0;
+        transformCount = 0;
+        atlas = nil;
+    };
 
-    [renderQueue enumerateObjectsUsingBlock:^(RenderData * child, NSUInteger idx, BOOL *stop) {
-        GLKMatrix4 modelViewMatrix = GLKMatrix4Multiply( self.camera.modelViewMatrix, child.modelviewMatrix );
+    for( RenderData * child in renderQueue ) {
+        RAGeometry * geometry = child.geometry;
+        RAMeshAtlasSlot * slot = geometry.atlasSlot;
+        GLKMatrix4 modelMatrix = child.modelviewMatrix;
+        
+        // atlas meshes keep no vertices of their own, so they are always batched; a full
+        // transform table or another atlas draws what is queued first
+        if ( slot ) {
+            uint32_t t = 0;
+            while( t < transformCount && memcmp( &transforms[t], &modelMatrix, sizeof(GLKMatrix4) ) != 0 ) t++;
+            
+            if ( ( atlas != nil && slot.atlas != atlas ) || t == kMaxBatchTransforms ) {
+                drawQueuedBatches();
+                t = 0;
+            }
+            if ( t == transformCount ) transforms[transformCount++] = modelMatrix;
+            
+            atlas = slot.atlas;
+            items[itemCount].transform = t;
+            items[itemCount].textures[0] = geometry.texture0.name;
+            items[itemCount].textures[1] = geometry.texture1.name;
+            items[itemCount].textures[2] = geometry.texture2.name;
+            items[itemCount].page = slot.page;
+            items[itemCount].slot = slot.slot;
+            itemCount++;
+            continue;
+        }
+        
+        GLKMatrix4 modelViewMatrix = GLKMatrix4Multiply( self.camera.modelViewMatrix, modelMatrix );
         GLKMatrix4 modelViewProjectionMatrix = GLKMatrix4Multiply(self.camera.projectionMatrix, modelViewMatrix);
         
         [shader setUniform:UNIFORM_MODELVIEWPROJECTION_MATRIX toMatrix4:modelViewProjectionMatrix];
         
-        [child.geometry renderGL];
-    }];
+        [geometry renderGL];
+        drawCount++;
+    }
+    
+    drawQueuedBatches();
+    
+    free( items );
+    free( batches );
+    free( transforms );
 }
 
 /*- (void)applyNode:(RANode *)node
@@ -180,6 +265,11 @@ enum
     [renderQueue addObject: data];
 }
 
+- (BOOL)isBoundCulled:(RABoundingSphere)worldBound
+{
+    return ! [self.camera isBoundOnscreen:worldBound];
+}
+
 - (void)applyPageNode:(RAPageNode *)node
 {
     GLKMatrix4 modelViewMatrix = GLKMatrix4Multiply( self.camera.modelViewMatrix, [self currentTransform] );
@@ -201,7 +291,7 @@ enum
     float texelError = [page calculateScreenSpaceErrorWithCamera:self.camera];
     
     // should we choose to display this page?
-    if ( texelError < 5.0f && page.isReady ) {
+    if ( texelError < self.errorThreshold && page.isReady ) {
         [self applyGeometry: page.geometry];
         return;
     }
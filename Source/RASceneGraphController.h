@@ -29,4 +29,7 @@
 
 - (IBAction)flyToLocationFrom:(id)sender;
 
+// remembers the view and the tiles showing it, so the next launch starts from them
+- (void)saveState;
+
 @end
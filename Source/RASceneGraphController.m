@@ -15,11 +15,18 @@
 #import "RABoundingSphere.h"
 #import "RANodeVisitor.h"
 #import "RARenderVisitor.h"
+#import "RACompiledGraph.h"
 #import "RAGeographicUtils.h"
 
 #import "RATileDatabase.h"
 #import "RATilePager.h"
 
+static NSString * kCameraStateKey = @"RACameraState";
+static NSString * kSnapshotFileName = @"RATilePagerSnapshot.plist";
+
+static const NSTimeInterval kPrefetchInterval = 1.0;           // how often to re-predict the camera path
+static const NSTimeInterval kPrefetchSampleInterval = 0.5;     // spacing of predicted cameras along the path
+
 
 #pragma mark -
 
@@ -37,18 +44,22 @@
 
 @interface RASceneGraphController () {
     RARenderVisitor *   _renderVisitor;
+    RACompiledGraph *   _compiledScene;
     
     EAGLContext *       _context;
     GLKSkyboxEffect *   _skybox;
     CADisplayLink *     _displayLink;
     
     BOOL                _needsDisplay;
+    BOOL                _needsPagerUpdate;
+    NSTimeInterval      _lastPrefetchTime;
 }
 
 - (void)setupGL;
 - (void)tearDownGL;
 - (void)setupSceneObjects;
 - (RANode *)createSceneGraphForPager:(RATilePager *)pager;
+- (void)restoreState;
 - (void)update;
 
 @end
@@ -104,10 +115,11 @@
     _pager = [RATilePager new];
     _pager.imageryDatabase = database;
     _pager.camera = self.camera;
+    _manipulator.pager = _pager;
     
     // setup scene
     [_pager setupPages];
-    _sceneRoot = [self createSceneGraphForPager:_pager];
+    self.sceneRoot = [self createSceneGraphForPager:_pager];
 }
 
 - (void)viewDidLoad
@@ -150,6 +162,7 @@
     
     _needsDisplay = YES;
     [self setupGL];
+    [self restoreState];
     [_pager requestUpdate];
 }
 
@@ -173,6 +186,46 @@
     // Release any cached data, images, etc. that aren't in use.
     [RATextureWrapper cleanupAll: YES];
     [RAGeometry cleanupAll: YES];
+    [[RABufferPool sharedPool] purge];
+}
+
+- (NSString *)snapshotPath
+{
+    NSString * caches = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) lastObject];
+    return [caches stringByAppendingPathComponent:kSnapshotFileName];
+}
+
+- (void)saveState
+{
+    NSDictionary * cameraState = [NSDictionary dictionaryWithObjectsAndKeys:
+                                  [NSNumber numberWithDouble:_manipulator.latitude], @"latitude",
+                                  [NSNumber numberWithDouble:_manipulator.longitude], @"longitude",
+                                  [NSNumber numberWithDouble:_manipulator.azimuth], @"azimuth",
+                                  [NSNumber numberWithDouble:_manipulator.elevation], @"elevation",
+                                  [NSNumber numberWithDouble:_manipulator.distance], @"distance",
+                                  nil];
+    
+    [[NSUserDefaults standardUserDefaults] setObject:cameraState forKey:kCameraStateKey];
+    [[NSUserDefaults standardUserDefaults] synchronize];
+    
+    [_pager saveSnapshotToFile:[self snapshotPath]];
+}
+
+- (void)restoreState
+{
+    // the tiles are only worth loading early from the same view
+    NSDictionary * cameraState = [[NSUserDefaults standardUserDefaults] dictionaryForKey:kCameraStateKey];
+    if ( cameraState == nil ) return;
+    
+    [_manipulator beginUpdates];
+    _manipulator.latitude = [[cameraState objectForKey:@"latitude"] doubleValue];
+    _manipulator.longitude = [[cameraState objectForKey:@"longitude"] doubleValue];
+    _manipulator.azimuth = [[cameraState objectForKey:@"azimuth"] doubleValue];
+    _manipulator.elevation = [[cameraState objectForKey:@"elevation"] doubleValue];
+    _manipulator.distance = [[cameraState objectForKey:@"distance"] doubleValue];
+    [_manipulator endUpdates];
+    
+    [_pager restoreSnapshotFromFile:[self snapshotPath]];
 }
 
 - (BOOL)shouldAutorotateToInterfaceOrientation:(UIInterfaceOrientation)interfaceOrientation
@@ -193,7 +246,17 @@
 }
 
 - (void)displayLinkUpdate:(CADisplayLink *)sender {
-    if ( _needsDisplay ) {
+    // camera animations step on this tick, so their change is drawn in the same frame
+    [_manipulator stepAnimations];
+    
+    // changes since the last tick are handled together
+    if ( _needsPagerUpdate ) {
+        [_pager requestUpdate];
+        _needsPagerUpdate = NO;
+    }
+    
+    // keep drawing while uploads are spread across frames
+    if ( _needsDisplay || _pager.uploadScheduler.pendingCount > 0 ) {
         [self update];
         [glView display];
         
@@ -202,10 +265,19 @@
 }
 
 - (void)displayNotification:(NSNotification *)note {
-    [_pager requestUpdate];
+    _needsPagerUpdate = YES;
     _needsDisplay = YES;
 }
 
+- (RANode *)sceneRoot {
+    return _sceneRoot;
+}
+
+- (void)setSceneRoot:(RANode *)sceneRoot {
+    _sceneRoot = sceneRoot;
+    _compiledScene = [[RACompiledGraph alloc] initWithRoot:sceneRoot];
+}
+
 - (EAGLContext *)context {
     return _context;
 }
@@ -317,7 +389,25 @@
         };
         GLKVector3 lightEcef = ConvertPolarToEcef( lightPolar );
         _renderVisitor.lightPosition = lightEcef;
+        
+        // look ahead along any animated camera path so tiles are ready on arrival
+        NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+        if ( now - _lastPrefetchTime > kPrefetchInterval ) {
+            _lastPrefetchTime = now;
+            [_pager prefetchForCameras:[_manipulator predictedCamerasWithInterval:kPrefetchSampleInterval]];
+        }
+    }
+    
+    // overlays blend at their current opacity
+    GLKVector4 overlayOpacity = GLKVector4Make(0, 0, 0, 0);
+    NSArray * overlays = _pager.overlays;
+    for( NSUInteger idx = 0; idx < overlays.count; idx++ ) {
+        overlayOpacity.v[idx] = [[overlays objectAtIndex:idx] opacity];
     }
+    _renderVisitor.overlayOpacity = overlayOpacity;
+    
+    // only nodes that changed since the last frame are recalculated
+    [_compiledScene update];
     
     self.camera.viewport = self.glView.bounds;
     [_camera calculateProjectionForBounds: self.sceneRoot.bound];
@@ -342,10 +432,13 @@
     
     glClear(GL_DEPTH_BUFFER_BIT);
 
+    // move this frame's share of new tiles to the GPU
+    [_pager processUploads];
+
     // run the render visitor
     if ( clippingEnable == nil || clippingEnable.on ) {
         [_renderVisitor clear];
-        [self.sceneRoot accept: _renderVisitor];
+        [_renderVisitor traverseCompiledGraph: _compiledScene];
     }
     [_renderVisitor render];
     
@@ -366,7 +459,7 @@
     [RAGeometry cleanupAll:NO];
     
     // show stats
-    [statsLabel setText:_renderVisitor.statsString];
+    [statsLabel setText:[NSString stringWithFormat:@"%@, %@", _renderVisitor.statsString, _pager.statsString]];
 }
 
 @end
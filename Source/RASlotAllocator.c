@@ -0,0 +1,70 @@
+//
+//  RASlotAllocator.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/6/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#include "RASlotAllocator.h"
+
+#include <stdlib.h>
+#include <assert.h>
+
+#define kBitsPerWord 32
+
+bool RASlotAllocatorInit( RASlotAllocator * allocator, int capacity )
+{
+    int words = ( capacity + kBitsPerWord - 1 ) / kBitsPerWord;
+
+    allocator->bits = (uint32_t *)calloc( words, sizeof(uint32_t) );
+    allocator->capacity = capacity;
+    allocator->count = 0;
+    return ( allocator->bits != NULL );
+}
+
+void RASlotAllocatorDestroy( RASlotAllocator * allocator )
+{
+    free( allocator->bits );
+    allocator->bits = NULL;
+    allocator->capacity = allocator->count = 0;
+}
+
+int RASlotAllocatorAcquire( RASlotAllocator * allocator )
+{
+    if ( RASlotAllocatorIsFull(allocator) ) return -1;
+
+    int words = ( allocator->capacity + kBitsPerWord - 1 ) / kBitsPerWord;
+    for( int w = 0; w < words; w++ ) {
+        uint32_t used = allocator->bits[w];
+        if ( used == 0xFFFFFFFF ) continue;
+
+        // lowest clear bit
+        int bit = __builtin_ctz( ~used );
+        int slot = w * kBitsPerWord + bit;
+        if ( slot >= allocator->capacity ) break;
+
+        allocator->bits[w] |= ( 1u << bit );
+        allocator->count++;
+        return slot;
+    }
+
+    return -1;
+}
+
+void RASlotAllocatorRelease( RASlotAllocator * allocator, int slot )
+{
+    assert( slot >= 0 && slot < allocator->capacity );
+
+    uint32_t mask = 1u << ( slot % kBitsPerWord );
+    uint32_t * word = &allocator->bits[ slot / kBitsPerWord ];
+
+    assert( *word & mask );
+    *word &= ~mask;
+    allocator->count--;
+}
+
+bool RASlotAllocatorIsFull( const RASlotAllocator * allocator )
+{
+    return allocator->count >= allocator->capacity;
+}
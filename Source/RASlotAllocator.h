@@ -0,0 +1,29 @@
+//
+//  RASlotAllocator.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/6/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#ifndef EarthViewExample_RASlotAllocator_h
+#define EarthViewExample_RASlotAllocator_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// hands out fixed-size slots of a page, lowest index first so live slots stay packed
+typedef struct {
+    uint32_t *  bits;       // set bits are in use
+    int         capacity;
+    int         count;
+} RASlotAllocator;
+
+bool RASlotAllocatorInit( RASlotAllocator * allocator, int capacity );
+void RASlotAllocatorDestroy( RASlotAllocator * allocator );
+
+int RASlotAllocatorAcquire( RASlotAllocator * allocator );     // -1 when full
+void RASlotAllocatorRelease( RASlotAllocator * allocator, int slot );
+bool RASlotAllocatorIsFull( const RASlotAllocator * allocator );
+
+#endif
@@ -0,0 +1,253 @@
+//
+//  RATerrainCodec.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/8/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#include "RATerrainCodec.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define kInflateChunkSize (4096)
+
+static const uint8_t kMagic[4] = { 'R', 'A', 'H', 'F' };
+
+
+static uint16_t ReadUInt16( const uint8_t * p )
+{
+    return (uint16_t)( p[0] | ( p[1] << 8 ) );
+}
+
+static float ReadFloat32( const uint8_t * p )
+{
+    uint32_t bits = (uint32_t)p[0] | ( (uint32_t)p[1] << 8 ) | ( (uint32_t)p[2] << 16 ) | ( (uint32_t)p[3] << 24 );
+    float value;
+    memcpy( &value, &bits, sizeof(value) );
+    return value;
+}
+
+static void WriteUInt16( uint8_t * p, uint16_t value )
+{
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+}
+
+static void WriteFloat32( uint8_t * p, float value )
+{
+    uint32_t bits;
+    memcpy( &bits, &value, sizeof(bits) );
+    p[0] = bits & 0xFF;
+    p[1] = ( bits >> 8 ) & 0xFF;
+    p[2] = ( bits >> 16 ) & 0xFF;
+    p[3] = bits >> 24;
+}
+
+bool RATerrainReadHeader( const void * bytes, size_t length, RATerrainHeader * header )
+{
+    const uint8_t * p = (const uint8_t *)bytes;
+    if ( length < kRATerrainHeaderSize || memcmp( p, kMagic, sizeof(kMagic) ) != 0 ) return false;
+    
+    header->version = p[4];
+    header->flags = p[5];
+    header->width = ReadUInt16( p + 6 );
+    header->height = ReadUInt16( p + 8 );
+    header->minHeight = ReadFloat32( p + 12 );
+    header->maxHeight = ReadFloat32( p + 16 );
+    
+    if ( header->version != kRATerrainVersion ) return false;
+    if ( header->flags & ~( RATerrainFlagDelta | RATerrainFlagDeflate ) ) return false;
+    if ( header->width < 2 || header->height < 2 ) return false;
+    if ( !( header->maxHeight >= header->minHeight ) ) return false;    // also rejects NaN
+    
+    return true;
+}
+
+bool RATerrainEncode( const RAHeightMap * map, uint8_t flags, uint8_t ** bytes, size_t * length )
+{
+    if ( map->heights == NULL || map->width < 2 || map->height < 2 || map->width > 0xFFFF || map->height > 0xFFFF ) return false;
+    
+    size_t count = (size_t)map->width * map->height;
+    float lo = map->heights[0], hi = map->heights[0];
+    for( size_t i = 1; i < count; i++ ) {
+        lo = fminf( lo, map->heights[i] );
+        hi = fmaxf( hi, map->heights[i] );
+    }
+    
+    // quantize
+    size_t sampleBytes = count * sizeof(uint16_t);
+    uint8_t * samples = (uint8_t *)malloc( sampleBytes );
+    if ( samples == NULL ) return false;
+    
+    float scale = ( hi > lo ) ? 65535.0f / ( hi - lo ) : 0.0f;
+    uint16_t previous = 0;
+    for( size_t i = 0; i < count; i++ ) {
+        uint16_t q = (uint16_t)lrintf( ( map->heights[i] - lo ) * scale );
+        WriteUInt16( samples + i * 2, ( flags & RATerrainFlagDelta ) ? (uint16_t)( q - previous ) : q );
+        previous = q;
+    }
+    
+    size_t capacity = kRATerrainHeaderSize + ( ( flags & RATerrainFlagDeflate ) ? compressBound( sampleBytes ) : sampleBytes );
+    uint8_t * out = (uint8_t *)malloc( capacity );
+    if ( out == NULL ) {
+        free( samples );
+        return false;
+    }
+    
+    memcpy( out, kMagic, sizeof(kMagic) );
+    out[4] = kRATerrainVersion;
+    out[5] = flags;
+    WriteUInt16( out + 6, map->width );
+    WriteUInt16( out + 8, map->height );
+    WriteUInt16( out + 10, 0 );
+    WriteFloat32( out + 12, lo );
+    WriteFloat32( out + 16, hi );
+    
+    size_t payloadLength = sampleBytes;
+    if ( flags & RATerrainFlagDeflate ) {
+        uLongf compressedLength = capacity - kRATerrainHeaderSize;
+        if ( compress2( out + kRATerrainHeaderSize, &compressedLength, samples, sampleBytes, Z_BEST_COMPRESSION ) != Z_OK ) {
+            free( samples );
+            free( out );
+            return false;
+        }
+        payloadLength = compressedLength;
+    } else {
+        memcpy( out + kRATerrainHeaderSize, samples, sampleBytes );
+    }
+    
+    free( samples );
+    *bytes = out;
+    *length = kRATerrainHeaderSize + payloadLength;
+    return true;
+}
+
+#pragma mark -
+
+void RATerrainDecoderInit( RATerrainDecoder * decoder )
+{
+    memset( decoder, 0, sizeof(RATerrainDecoder) );
+    decoder->status = RATerrainDecodeNeedsData;
+}
+
+void RATerrainDecoderDestroy( RATerrainDecoder * decoder )
+{
+    if ( decoder->streamOpen ) inflateEnd( &decoder->stream );
+    decoder->streamOpen = false;
+    RAHeightMapDestroy( &decoder->map );
+}
+
+static RATerrainDecodeStatus Fail( RATerrainDecoder * decoder )
+{
+    decoder->status = RATerrainDecodeError;
+    return decoder->status;
+}
+
+static bool BeginSamples( RATerrainDecoder * decoder )
+{
+    if ( ! RATerrainReadHeader( decoder->headerBytes, kRATerrainHeaderSize, &decoder->header ) ) return false;
+    if ( ! RAHeightMapInit( &decoder->map, decoder->header.width, decoder->header.height ) ) return false;
+    
+    decoder->map.minHeight = decoder->header.minHeight;
+    decoder->map.maxHeight = decoder->header.maxHeight;
+    decoder->sampleCount = (size_t)decoder->header.width * decoder->header.height;
+    decoder->sampleScale = ( decoder->header.maxHeight - decoder->header.minHeight ) / 65535.0f;
+    
+    if ( decoder->header.flags & RATerrainFlagDeflate ) {
+        if ( inflateInit( &decoder->stream ) != Z_OK ) return false;
+        decoder->streamOpen = true;
+    }
+    return true;
+}
+
+// turns sample bytes into heights
+static void EmitSamples( RATerrainDecoder * decoder, const uint8_t * p, size_t length )
+{
+    bool delta = ( decoder->header.flags & RATerrainFlagDelta ) != 0;
+    float base = decoder->header.minHeight, scale = decoder->sampleScale;
+    float * out = decoder->map.heights;
+    size_t index = decoder->sampleIndex, count = decoder->sampleCount;
+    uint16_t previous = decoder->previous;
+    
+    if ( decoder->hasCarry && length > 0 && index < count ) {
+        uint16_t q = (uint16_t)( decoder->carry | ( p[0] << 8 ) );
+        if ( delta ) q = previous = (uint16_t)( previous + q );
+        out[index++] = base + q * scale;
+        decoder->hasCarry = false;
+        p++, length--;
+    }
+    
+    while( length >= 2 && index < count ) {
+        uint16_t q = ReadUInt16( p );
+        if ( delta ) q = previous = (uint16_t)( previous + q );
+        out[index++] = base + q * scale;
+        p += 2, length -= 2;
+    }
+    
+    if ( length == 1 && index < count ) {
+        decoder->carry = p[0];
+        decoder->hasCarry = true;
+    }
+    
+    decoder->sampleIndex = index;
+    decoder->previous = previous;
+    if ( index == count ) decoder->status = RATerrainDecodeDone;
+}
+
+RATerrainDecodeStatus RATerrainDecoderFeed( RATerrainDecoder * decoder, const void * bytes, size_t length )
+{
+    const uint8_t * p = (const uint8_t *)bytes;
+    if ( decoder->status != RATerrainDecodeNeedsData ) return decoder->status;
+    
+    // header first
+    if ( decoder->headerLength < kRATerrainHeaderSize ) {
+        size_t n = kRATerrainHeaderSize - decoder->headerLength;
+        if ( n > length ) n = length;
+        
+        memcpy( decoder->headerBytes + decoder->headerLength, p, n );
+        decoder->headerLength += n;
+        p += n, length -= n;
+        
+        if ( decoder->headerLength < kRATerrainHeaderSize ) return decoder->status;
+        if ( ! BeginSamples( decoder ) ) return Fail( decoder );
+    }
+    
+    if ( ! decoder->streamOpen ) {
+        EmitSamples( decoder, p, length );
+        return decoder->status;
+    }
+    
+    // inflate a chunk at a time, so the whole payload is never held uncompressed
+    uint8_t chunk[kInflateChunkSize];
+    decoder->stream.next_in = (Bytef *)p;
+    decoder->stream.avail_in = (uInt)length;
+    
+    while( decoder->status == RATerrainDecodeNeedsData ) {
+        decoder->stream.next_out = chunk;
+        decoder->stream.avail_out = sizeof(chunk);
+        
+        int result = inflate( &decoder->stream, Z_NO_FLUSH );
+        if ( result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR ) return Fail( decoder );
+        
+        size_t produced = sizeof(chunk) - decoder->stream.avail_out;
+        EmitSamples( decoder, chunk, produced );
+        
+        if ( result == Z_STREAM_END && decoder->status != RATerrainDecodeDone ) return Fail( decoder );
+        if ( produced == 0 && decoder->stream.avail_in == 0 ) break;
+        if ( result == Z_BUF_ERROR ) break;
+    }
+    
+    return decoder->status;
+}
+
+bool RATerrainDecoderTakeMap( RATerrainDecoder * decoder, RAHeightMap * map )
+{
+    if ( decoder->status != RATerrainDecodeDone ) return false;
+    
+    *map = decoder->map;
+    memset( &decoder->map, 0, sizeof(RAHeightMap) );
+    return true;
+}
@@ -0,0 +1,88 @@
+//
+//  RATerrainCodec.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/8/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#ifndef EarthViewExample_RATerrainCodec_h
+#define EarthViewExample_RATerrainCodec_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <zlib.h>
+
+#include "RAHeightMap.h"
+
+// binary terrain tile, all fields little-endian:
+//   0   'RAHF'
+//   4   uint8   version (1)
+//   5   uint8   flags
+//   6   uint16  width
+//   8   uint16  height
+//   10  uint16  reserved
+//   12  float32 minimum height, meters
+//   16  float32 maximum height, meters
+//   20  width * height uint16 samples, rows from south to north, quantized over [min, max]
+// with RATerrainFlagDelta each sample is stored as the difference from the one before it, modulo 2^16
+// with RATerrainFlagDeflate the samples are a zlib stream
+
+#define kRATerrainHeaderSize    (20)
+#define kRATerrainVersion       (1)
+
+enum {
+    RATerrainFlagDelta      = 1 << 0,
+    RATerrainFlagDeflate    = 1 << 1
+};
+
+typedef struct {
+    uint8_t     version;
+    uint8_t     flags;
+    uint16_t    width;
+    uint16_t    height;
+    float       minHeight;
+    float       maxHeight;
+} RATerrainHeader;
+
+// false if the bytes don't start with a header this version can read
+bool RATerrainReadHeader( const void * bytes, size_t length, RATerrainHeader * header );
+
+// quantizes the map over its height range; the caller frees the returned bytes
+bool RATerrainEncode( const RAHeightMap * map, uint8_t flags, uint8_t ** bytes, size_t * length );
+
+typedef enum {
+    RATerrainDecodeNeedsData,
+    RATerrainDecodeDone,
+    RATerrainDecodeError
+} RATerrainDecodeStatus;
+
+// decodes a tile as its bytes arrive, writing heights straight into the map
+typedef struct {
+    RATerrainDecodeStatus   status;
+    RATerrainHeader         header;
+    uint8_t                 headerBytes[kRATerrainHeaderSize];
+    size_t                  headerLength;
+    
+    RAHeightMap             map;
+    size_t                  sampleCount;
+    size_t                  sampleIndex;
+    float                   sampleScale;
+    uint16_t                previous;
+    uint8_t                 carry;          // first byte of a sample split across calls
+    bool                    hasCarry;
+    
+    z_stream                stream;
+    bool                    streamOpen;
+} RATerrainDecoder;
+
+void RATerrainDecoderInit( RATerrainDecoder * decoder );
+void RATerrainDecoderDestroy( RATerrainDecoder * decoder );
+
+RATerrainDecodeStatus RATerrainDecoderFeed( RATerrainDecoder * decoder, const void * bytes, size_t length );
+
+// hands over the heights once decoding is done; the caller destroys the map
+bool RATerrainDecoderTakeMap( RATerrainDecoder * decoder, RAHeightMap * map );
+
+#endif
@@ -0,0 +1,32 @@
+//
+//  RATerrainTile.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/8/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <GLKit/GLKMathTypes.h>
+
+#include "RAHeightMap.h"
+
+// full white in a grayscale terrain image
+extern const float kRATerrainImageFullScale;    // meters
+
+// the heights of one terrain tile, decoded once and shared by every mesh built from it
+@interface RATerrainTile : NSObject
+
+@property (readonly) NSUInteger width;
+@property (readonly) NSUInteger height;
+@property (readonly) float minHeight;       // meters
+@property (readonly) float maxHeight;
+@property (readonly) const RAHeightMap * map;
+
+- (id)initWithData:(NSData *)data;          // binary terrain, see RATerrainCodec.h
+- (id)initWithImage:(UIImage *)image;       // grayscale, scaled by kRATerrainImageFullScale
+
+// bilinear, in meters; coordinates run 0 to 1 across the tile from the south-west corner
+- (float)heightAtTextureCoords:(GLKVector2)tex;
+
+@end
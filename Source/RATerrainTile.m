@@ -0,0 +1,103 @@
+//
+//  RATerrainTile.m
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/8/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import "RATerrainTile.h"
+
+#include "RATerrainCodec.h"
+
+const float kRATerrainImageFullScale = 15000.0f;
+
+
+@implementation RATerrainTile {
+    RAHeightMap     _map;
+}
+
+- (id)initWithData:(NSData *)data {
+    self = [super init];
+    if ( self ) {
+        if ( data == nil ) return nil;
+        
+        RATerrainDecoder decoder;
+        RATerrainDecoderInit( &decoder );
+        RATerrainDecoderFeed( &decoder, [data bytes], [data length] );
+        
+        BOOL success = RATerrainDecoderTakeMap( &decoder, &_map );
+        RATerrainDecoderDestroy( &decoder );
+        
+        if ( ! success ) return nil;
+    }
+    return self;
+}
+
+- (id)initWithImage:(UIImage *)image {
+    self = [super init];
+    if ( self ) {
+        if ( image == nil ) return nil;
+        
+        CGImageRef imageRef = [image CGImage];
+        size_t width = CGImageGetWidth(imageRef);
+        size_t height = CGImageGetHeight(imageRef);
+        if ( width < 2 || height < 2 ) return nil;
+        
+        // a single gray channel is all the heights need
+        unsigned char * gray = (unsigned char *)calloc( width * height, sizeof(unsigned char) );
+        CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceGray();
+        CGContextRef context = CGBitmapContextCreate( gray, width, height, 8, width, colorSpace, kCGImageAlphaNone );
+        CGColorSpaceRelease(colorSpace);
+        
+        CGContextDrawImage(context, CGRectMake(0, 0, width, height), imageRef);
+        CGContextRelease(context);
+        
+        if ( ! RAHeightMapInit( &_map, width, height ) ) {
+            free( gray );
+            return nil;
+        }
+        
+        // image rows run north to south
+        const float scale = kRATerrainImageFullScale / 255.0f;
+        for( size_t y = 0; y < height; y++ ) {
+            const unsigned char * src = gray + ( height - 1 - y ) * width;
+            float * dst = _map.heights + y * width;
+            for( size_t x = 0; x < width; x++ ) dst[x] = src[x] * scale;
+        }
+        
+        free( gray );
+        RAHeightMapUpdateRange( &_map );
+    }
+    return self;
+}
+
+- (void)dealloc {
+    RAHeightMapDestroy( &_map );
+}
+
+- (NSUInteger)width {
+    return _map.width;
+}
+
+- (NSUInteger)height {
+    return _map.height;
+}
+
+- (float)minHeight {
+    return _map.minHeight;
+}
+
+- (float)maxHeight {
+    return _map.maxHeight;
+}
+
+- (const RAHeightMap *)map {
+    return &_map;
+}
+
+- (float)heightAtTextureCoords:(GLKVector2)tex {
+    return RAHeightMapSample( &_map, tex.x, tex.y );
+}
+
+@end
@@ -0,0 +1,226 @@
+//
+//  RATerrainTree.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/3/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#include "RATerrainTree.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#define kMaxStackDepth 64
+
+
+static const float * Position( const RATerrainTree * tree, int x, int y )
+{
+    return tree->positions + 3 * ( y * tree->width + x );
+}
+
+static void Subtract( const float a[3], const float b[3], float out[3] )
+{
+    for( int i = 0; i < 3; i++ ) out[i] = a[i] - b[i];
+}
+
+static float Dot( const float a[3], const float b[3] )
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void Cross( const float a[3], const float b[3], float out[3] )
+{
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static bool IntersectBox( const float lower[3], const float upper[3], const float start[3], const float invDir[3], float maxT, float * tnear )
+{
+    // slab test; fminf/fmaxf discard the NaN from a zero direction component on a slab plane
+    float t0 = 0.0f, t1 = maxT;
+    for( int i = 0; i < 3; i++ ) {
+        float ta = ( lower[i] - start[i] ) * invDir[i];
+        float tb = ( upper[i] - start[i] ) * invDir[i];
+        t0 = fmaxf( t0, fminf(ta, tb) );
+        t1 = fminf( t1, fmaxf(ta, tb) );
+        if ( t0 > t1 ) return false;
+    }
+
+    *tnear = t0;
+    return true;
+}
+
+static bool IntersectTriangle( const float start[3], const float dir[3], const float v0[3], const float v1[3], const float v2[3], float * t )
+{
+    // Moller-Trumbore, t is in units of dir
+    float e1[3], e2[3], p[3], s[3], q[3];
+    Subtract( v1, v0, e1 );
+    Subtract( v2, v0, e2 );
+    Cross( dir, e2, p );
+    float det = Dot( e1, p );
+    if ( det == 0.0f ) return false;
+
+    float invDet = 1.0f / det;
+    Subtract( start, v0, s );
+    float u = Dot( s, p ) * invDet;
+    if ( u < 0.0f || u > 1.0f ) return false;
+
+    Cross( s, e1, q );
+    float v = Dot( dir, q ) * invDet;
+    if ( v < 0.0f || u + v > 1.0f ) return false;
+
+    *t = Dot( e2, q ) * invDet;
+    return ( *t >= 0.0f );
+}
+
+static void BuildNode( RATerrainTree * tree, int idx, int x0, int y0, int x1, int y1 )
+{
+    RATerrainTreeNode * node = &tree->nodes[idx];
+    node->x0 = x0; node->y0 = y0;
+    node->x1 = x1; node->y1 = y1;
+    node->firstChild = -1;
+    node->childCount = 0;
+
+    if ( x1 - x0 == 1 && y1 - y0 == 1 ) {
+        // the cell's triangles are flat, so the box of its corners contains them
+        const float * corners[4] = { Position(tree, x0, y0), Position(tree, x1, y0), Position(tree, x0, y1), Position(tree, x1, y1) };
+        for( int i = 0; i < 3; i++ ) {
+            node->lower[i] = fminf( fminf(corners[0][i], corners[1][i]), fminf(corners[2][i], corners[3][i]) );
+            node->upper[i] = fmaxf( fmaxf(corners[0][i], corners[1][i]), fmaxf(corners[2][i], corners[3][i]) );
+        }
+        return;
+    }
+
+    // split each axis that spans more than one cell
+    int xs[3] = { x0, x1, x1 }, ys[3] = { y0, y1, y1 };
+    int nx = 1, ny = 1;
+    if ( x1 - x0 > 1 ) { xs[1] = ( x0 + x1 ) / 2; nx = 2; }
+    if ( y1 - y0 > 1 ) { ys[1] = ( y0 + y1 ) / 2; ny = 2; }
+
+    // reserve the children together, then fill in their subtrees
+    int first = tree->nodeCount;
+    tree->nodeCount += nx * ny;
+    node->firstChild = first;
+    node->childCount = nx * ny;
+
+    int child = first;
+    for( int j = 0; j < ny; j++ ) {
+        for( int i = 0; i < nx; i++ ) {
+            BuildNode( tree, child++, xs[i], ys[j], xs[i+1], ys[j+1] );
+        }
+    }
+
+    // the node array is not reallocated, so the pointer is still good
+    for( int i = 0; i < 3; i++ ) {
+        node->lower[i] = tree->nodes[first].lower[i];
+        node->upper[i] = tree->nodes[first].upper[i];
+        for( int c = first + 1; c < first + node->childCount; c++ ) {
+            node->lower[i] = fminf( node->lower[i], tree->nodes[c].lower[i] );
+            node->upper[i] = fmaxf( node->upper[i], tree->nodes[c].upper[i] );
+        }
+    }
+}
+
+bool RATerrainTreeInit( RATerrainTree * tree, const float * vertices, int width, int height, int vertexStride, int rowStride )
+{
+    assert( width > 1 && height > 1 );
+
+    tree->width = width;
+    tree->height = height;
+
+    // every split at least halves a range, so there are fewer nodes than twice the cells
+    int cells = ( width - 1 ) * ( height - 1 );
+    tree->positions = (float *)malloc( 3 * width * height * sizeof(float) );
+    tree->nodes = (RATerrainTreeNode *)malloc( 2 * cells * sizeof(RATerrainTreeNode) );
+    tree->nodeCount = 0;
+    if ( tree->positions == NULL || tree->nodes == NULL ) {
+        RATerrainTreeDestroy( tree );
+        return false;
+    }
+
+    for( int y = 0; y < height; y++ ) {
+        const float * row = vertices + y * rowStride;
+        for( int x = 0; x < width; x++ ) {
+            const float * v = row + x * vertexStride;
+            float * p = tree->positions + 3 * ( y * width + x );
+            p[0] = v[0]; p[1] = v[1]; p[2] = v[2];
+        }
+    }
+
+    tree->nodeCount = 1;
+    BuildNode( tree, 0, 0, 0, width - 1, height - 1 );
+    assert( tree->nodeCount <= 2 * cells );
+    return true;
+}
+
+void RATerrainTreeDestroy( RATerrainTree * tree )
+{
+    free( tree->positions );
+    free( tree->nodes );
+    tree->positions = NULL;
+    tree->nodes = NULL;
+    tree->nodeCount = tree->width = tree->height = 0;
+}
+
+bool RATerrainTreeIntersect( const RATerrainTree * tree, const float start[3], const float end[3], float * fraction, int x0, int y0, int x1, int y1 )
+{
+    const RATerrainTreeNode * nodes = tree->nodes;
+
+    float dir[3], invDir[3];
+    Subtract( end, start, dir );
+    for( int i = 0; i < 3; i++ ) invDir[i] = 1.0f / dir[i];
+    float best = fraction ? *fraction : 1.0f;
+    bool found = false;
+
+    int stack[kMaxStackDepth];
+    int depth = 0;
+    float tnear;
+
+    if ( IntersectBox( nodes[0].lower, nodes[0].upper, start, invDir, best, &tnear ) ) stack[depth++] = 0;
+
+    while( depth > 0 ) {
+        const RATerrainTreeNode * node = &nodes[ stack[--depth] ];
+
+        // skip nodes outside the requested cells
+        if ( node->x1 <= x0 || node->x0 >= x1 || node->y1 <= y0 || node->y0 >= y1 ) continue;
+
+        // a nearer hit may have been found since this node was pushed
+        if ( ! IntersectBox( node->lower, node->upper, start, invDir, best, &tnear ) ) continue;
+
+        if ( node->firstChild < 0 ) {
+            // same triangulation as the tile mesh
+            const float * v00 = Position(tree, node->x0, node->y0), * v10 = Position(tree, node->x1, node->y0);
+            const float * v01 = Position(tree, node->x0, node->y1), * v11 = Position(tree, node->x1, node->y1);
+            float t;
+            if ( IntersectTriangle( start, dir, v00, v10, v01, &t ) && t <= best ) { best = t; found = true; }
+            if ( IntersectTriangle( start, dir, v10, v11, v01, &t ) && t <= best ) { best = t; found = true; }
+            continue;
+        }
+
+        // push the children far to near so the nearest is visited first
+        int order[4];
+        float near[4];
+        int count = 0;
+        for( int c = node->firstChild; c < node->firstChild + node->childCount; c++ ) {
+            if ( ! IntersectBox( nodes[c].lower, nodes[c].upper, start, invDir, best, &tnear ) ) continue;
+
+            int k = count++;
+            while( k > 0 && near[k-1] < tnear ) {
+                order[k] = order[k-1];
+                near[k] = near[k-1];
+                k--;
+            }
+            order[k] = c;
+            near[k] = tnear;
+        }
+
+        assert( depth + count <= kMaxStackDepth );
+        for( int k = 0; k < count; k++ ) stack[depth++] = order[k];
+    }
+
+    if ( found && fraction ) *fraction = best;
+    return found;
+}
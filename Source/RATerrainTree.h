@@ -0,0 +1,41 @@
+//
+//  RATerrainTree.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/3/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#ifndef EarthViewExample_RATerrainTree_h
+#define EarthViewExample_RATerrainTree_h
+
+#include <stdbool.h>
+
+// each node covers the cells [x0,x1) x [y0,y1); leaves are a single cell
+typedef struct {
+    float   lower[3];
+    float   upper[3];
+    int     x0, y0, x1, y1;
+    int     firstChild;     // children are stored contiguously, -1 for leaves
+    int     childCount;
+} RATerrainTreeNode;
+
+// the terrain surface of a tile as a grid of positions, with a hierarchy of bounding
+// boxes over its cells so a ray only visits the cells it could hit
+typedef struct {
+    float *                 positions;  // three floats per grid point, rows packed
+    RATerrainTreeNode *     nodes;
+    int                     nodeCount;
+    int                     width;
+    int                     height;
+} RATerrainTree;
+
+// positions are copied from the first three floats of each vertex; strides are in floats
+bool RATerrainTreeInit( RATerrainTree * tree, const float * vertices, int width, int height, int vertexStride, int rowStride );
+void RATerrainTreeDestroy( RATerrainTree * tree );
+
+// fraction is the hit distance along the segment; only hits nearer than its input value are
+// reported. only the cells in columns [x0,x1) and rows [y0,y1) are tested.
+bool RATerrainTreeIntersect( const RATerrainTree * tree, const float start[3], const float end[3], float * fraction, int x0, int y0, int x1, int y1 );
+
+#endif
@@ -0,0 +1,28 @@
+//
+//  RATextureAtlas.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/6/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "RATextureWrapper.h"
+
+// packs equally sized images into shared textures, so meshes using them can be drawn together
+@interface RATextureAtlas : NSObject
+
+@property (readonly) GLuint pageSize;
+@property (readonly) GLuint slotWidth;
+@property (readonly) GLuint slotHeight;
+@property (readonly) NSUInteger pageCount;
+@property (readonly) NSUInteger slotCount;      // images currently stored
+
+- (id)initWithPageSize:(GLuint)pageSize slotWidth:(GLuint)width slotHeight:(GLuint)height;
+
+// must be called within a context; returns nil if the image is not slot sized
+// the returned texture gives its slot back when released
+- (RATextureWrapper *)textureWithPixelData:(NSData *)pixels width:(GLuint)width height:(GLuint)height;
+
+@end
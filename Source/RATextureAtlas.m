@@ -0,0 +1,151 @@
+//
+//  RATextureAtlas.m
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/6/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import "RATextureAtlas.h"
+
+#import <OpenGLES/EAGL.h>
+#import <OpenGLES/ES2/gl.h>
+
+#import "RASlotAllocator.h"
+
+
+@interface RAAtlasPage : NSObject
+@property (readonly) RATextureWrapper * texture;
+@property (readonly) NSUInteger count;
+- (id)initWithTexture:(RATextureWrapper *)texture slotCount:(int)slotCount;
+- (int)acquireSlot;
+- (void)releaseSlot:(int)slot;
+@end
+
+@implementation RAAtlasPage {
+    RASlotAllocator     _slots;
+}
+
+@synthesize texture = _texture;
+
+- (id)initWithTexture:(RATextureWrapper *)texture slotCount:(int)slotCount {
+    self = [super init];
+    if ( self ) {
+        _texture = texture;
+        if ( ! RASlotAllocatorInit( &_slots, slotCount ) ) return nil;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    RASlotAllocatorDestroy( &_slots );
+}
+
+- (NSUInteger)count {
+    @synchronized(self) {
+        return _slots.count;
+    }
+}
+
+- (int)acquireSlot {
+    @synchronized(self) {
+        return RASlotAllocatorAcquire( &_slots );
+    }
+}
+
+- (void)releaseSlot:(int)slot {
+    // textures can be released on any thread
+    @synchronized(self) {
+        RASlotAllocatorRelease( &_slots, slot );
+    }
+}
+
+@end
+
+
+@implementation RATextureAtlas {
+    NSMutableArray *    _pages;
+}
+
+@synthesize pageSize = _pageSize, slotWidth = _slotWidth, slotHeight = _slotHeight;
+
+- (id)initWithPageSize:(GLuint)pageSize slotWidth:(GLuint)width slotHeight:(GLuint)height {
+    NSAssert( width <= pageSize && height <= pageSize, @"slots must fit in a page" );
+    
+    self = [super init];
+    if ( self ) {
+        _pageSize = pageSize;
+        _slotWidth = width;
+        _slotHeight = height;
+        _pages = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (NSUInteger)pageCount {
+    @synchronized(self) {
+        return [_pages count];
+    }
+}
+
+- (NSUInteger)slotCount {
+    NSUInteger count = 0;
+    @synchronized(self) {
+        for( RAAtlasPage * page in _pages ) count += page.count;
+    }
+    return count;
+}
+
+- (RATextureWrapper *)textureWithPixelData:(NSData *)pixels width:(GLuint)width height:(GLuint)height {
+    NSAssert( [EAGLContext currentContext], @"must be called with an active context" );
+    
+    if ( pixels == nil || width != _slotWidth || height != _slotHeight ) return nil;
+    
+    RAAtlasPage * page = nil;
+    int slot = -1;
+    
+    @synchronized(self) {
+        // fill the earliest pages first, so later ones can drain
+        for( RAAtlasPage * candidate in _pages ) {
+            slot = [candidate acquireSlot];
+            if ( slot >= 0 ) {
+                page = candidate;
+                break;
+            }
+        }
+        
+        if ( page == nil ) {
+            int columns = _pageSize / _slotWidth;
+            int rows = _pageSize / _slotHeight;
+            
+            RATextureWrapper * texture = [[RATextureWrapper alloc] initWithWidth:_pageSize height:_pageSize];
+            page = [[RAAtlasPage alloc] initWithTexture:texture slotCount:(columns * rows)];
+            if ( page == nil ) return nil;
+            
+            [_pages addObject:page];
+            slot = [page acquireSlot];
+        }
+    }
+    
+    int columns = _pageSize / _slotWidth;
+    GLuint x = ( slot % columns ) * _slotWidth;
+    GLuint y = ( slot / columns ) * _slotHeight;
+    
+    glBindTexture( GL_TEXTURE_2D, page.texture.name );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    glTexSubImage2D( GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, [pixels bytes] );
+    
+    GLenum err = glGetError();
+    if ( err != GL_NO_ERROR )
+        NSLog(@"-[RATextureAtlas textureWithPixelData:]: glGetError = %d", err);
+    
+    // map 0 and 1 to the outer texel centers, so filtering never reads a neighbouring slot
+    GLKVector4 rect = GLKVector4Make( ( x + 0.5f ) / _pageSize, ( y + 0.5f ) / _pageSize,
+                                      ( width - 1.0f ) / _pageSize, ( height - 1.0f ) / _pageSize );
+    
+    return [[RATextureWrapper alloc] initWithRegion:rect ofTexture:page.texture width:width height:height onRelease:^{
+        [page releaseSlot:slot];
+    }];
+}
+
+@end
@@ -9,6 +9,7 @@
 #import <Foundation/Foundation.h>
 
 #import <GLKit/GLKTextureLoader.h>
+#import <GLKit/GLKVector4.h>
 
 // this class is a stand-in for GLKTextureInfo but adds the texture to a cleanup list when deallocated
 // this allows the texture to be easily shared across objects
@@ -18,10 +19,19 @@
 @property (readonly) GLenum                     target;
 @property (readonly) GLuint                     width;
 @property (readonly) GLuint                     height;
+@property (readonly) GLKVector4                 textureRect;    // s, t, width, height of the image within the texture
 
 + (void)cleanupAll:(BOOL)all;
 
+// decodes to y-flipped, premultiplied RGBA; safe to call without a context
++ (NSData *)pixelDataForImage:(UIImage *)image width:(GLuint *)width height:(GLuint *)height;
+
 - (id)initWithTextureInfo:(GLKTextureInfo *)info;
 - (id)initWithImage:(UIImage *)image;
+- (id)initWithPixelData:(NSData *)pixels width:(GLuint)width height:(GLuint)height;
+- (id)initWithWidth:(GLuint)width height:(GLuint)height;   // contents undefined
+
+// shares part of another texture, keeping it alive; the block runs when this is released
+- (id)initWithRegion:(GLKVector4)rect ofTexture:(RATextureWrapper *)texture width:(GLuint)width height:(GLuint)height onRelease:(void (^)(void))releaseBlock;
 
 @end
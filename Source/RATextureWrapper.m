@@ -12,13 +12,16 @@
 
 
 @implementation RATextureWrapper {
-    NSString *  _contextKey;
+    NSString *          _contextKey;
+    RATextureWrapper *  _parentTexture;
+    void                (^_releaseBlock)(void);
 }
 
 @synthesize name = _name;
 @synthesize target = _target;
 @synthesize width = _width;
 @synthesize height = _height;
+@synthesize textureRect = _textureRect;
 
 + (NSMutableSet *)textureDeletionSetForKey:(NSString *)key {
     static NSMutableDictionary * dict = nil;
@@ -77,6 +80,7 @@
         NSAssert( [EAGLContext currentContext], @"OpenGL ES context must be valid!" );
         NSString * key = [[[EAGLContext currentContext] sharegroup] description];
         _contextKey = key;
+        _textureRect = GLKVector4Make( 0, 0, 1, 1 );
     }
     return self;
 }
@@ -92,28 +96,86 @@
     return self;
 }
 
++ (NSData *)pixelDataForImage:(UIImage *)image width:(GLuint *)width height:(GLuint *)height {
+    if ( image == nil ) return nil;
+    
+    // get raw access to image data
+    CGImageRef imageRef = [image CGImage];
+    GLuint w = CGImageGetWidth(imageRef);
+    GLuint h = CGImageGetHeight(imageRef);
+    
+    char * pixels = (char *)calloc( h * w * 4, sizeof(char) );
+    NSUInteger bitsPerComponent = 8;
+    NSUInteger bytesPerPixel = 4;
+    NSUInteger bytesPerRow = bytesPerPixel * w;
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    
+    CGContextRef context = CGBitmapContextCreate( pixels, w, h, 
+                                                 bitsPerComponent, bytesPerRow, colorSpace,
+                                                 kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big );
+    
+    // draw, y-flipped
+    CGContextTranslateCTM( context, 0, h );
+    CGContextScaleCTM( context, 1.0f, -1.0f );
+    CGContextDrawImage(context, CGRectMake(0, 0, w, h), imageRef);
+    
+    CGContextRelease(context);
+    CGColorSpaceRelease(colorSpace);
+    
+    if ( width ) *width = w;
+    if ( height ) *height = h;
+    return [NSData dataWithBytesNoCopy:pixels length:(h * w * 4) freeWhenDone:YES];
+}
+
 - (id)initWithImage:(UIImage *)image {
+    GLuint width = 0, height = 0;
+    NSData * pixels = [[self class] pixelDataForImage:image width:&width height:&height];
+    return [self initWithPixelData:pixels width:width height:height];
+}
+
+- (id)initWithWidth:(GLuint)width height:(GLuint)height {
     self = [self init];
-    if ( self && image ) {
-        // get raw access to image data
-        CGImageRef imageRef = [image CGImage];
-        _width = CGImageGetWidth(imageRef);
-        _height = CGImageGetHeight(imageRef);
+    if ( self ) {
+        _width = width;
+        _height = height;
         
-        char * pixels = (char *)calloc( _height * _width * 4, sizeof(char) );
-        NSUInteger bitsPerComponent = 8;
-        NSUInteger bytesPerPixel = 4;
-        NSUInteger bytesPerRow = bytesPerPixel * _width;
-        CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+        GLuint texture;
+        glGenTextures( 1, &texture );
+        glBindTexture( GL_TEXTURE_2D, texture );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+        _target = GL_TEXTURE_2D;
+        _name = texture;
         
-        CGContextRef context = CGBitmapContextCreate( pixels, _width, _height, 
-                                                     bitsPerComponent, bytesPerRow, colorSpace,
-                                                     kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big );
+        glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, _width, _height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+    }
+    return self;
+}
+
+- (id)initWithRegion:(GLKVector4)rect ofTexture:(RATextureWrapper *)texture width:(GLuint)width height:(GLuint)height onRelease:(void (^)(void))releaseBlock {
+    self = [super init];
+    if ( self ) {
+        _parentTexture = texture;
+        _releaseBlock = [releaseBlock copy];
         
-        // draw, y-flipped
-        CGContextTranslateCTM( context, 0, _height );
-        CGContextScaleCTM( context, 1.0f, -1.0f );
-        CGContextDrawImage(context, CGRectMake(0, 0, _width, _height), imageRef);
+        // the parent owns the texture object
+        _name = texture.name;
+        _target = texture.target;
+        _width = width;
+        _height = height;
+        _textureRect = rect;
+    }
+    return self;
+}
+
+- (id)initWithPixelData:(NSData *)pixels width:(GLuint)width height:(GLuint)height {
+    self = [self init];
+    if ( self && pixels ) {
+        NSAssert( [pixels length] >= width * height * 4, @"pixel data is too short" );
+        _width = width;
+        _height = height;
         
         // generate texture object
         GLuint texture;
@@ -128,11 +190,7 @@
         
         // upload image
         glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
-        glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, _width, _height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
-        
-        CGContextRelease(context);
-        CGColorSpaceRelease(colorSpace);
-        free( pixels );
+        glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, _width, _height, 0, GL_RGBA, GL_UNSIGNED_BYTE, [pixels bytes] );
 
         // simple way to check that we don't have too many textures active
         if ( texture > 600 )
@@ -142,6 +200,8 @@
 }
 
 - (void)dealloc {
+    if ( _releaseBlock ) _releaseBlock();
+    
     if ( _name && _contextKey ) {
         NSMutableSet * set = [[self class] textureDeletionSetForKey:_contextKey];
 
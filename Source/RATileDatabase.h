@@ -18,6 +18,11 @@ typedef struct {
 
 TileID TileOppositeCorner( TileID t );
 
+typedef enum {
+    RATileFormatImage = 0,      // anything UIImage can read
+    RATileFormatTerrain         // binary heights, see RATerrainCodec.h
+} RATileFormat;
+
 
 @interface RATileDatabase : NSObject
 
@@ -32,6 +37,7 @@ TileID TileOppositeCorner( TileID t );
 @property (assign, nonatomic) NSUInteger minzoom;
 @property (assign, nonatomic) NSUInteger maxzoom;
 @property (assign, nonatomic) BOOL googleTileConvention;
+@property (assign, nonatomic) RATileFormat format;      // default: RATileFormatImage
 
 - (double)resolutionAtZoom:(NSUInteger)zoom;
 - (CGPoint)latLonToMeters:(RAPolarCoordinate)coord;
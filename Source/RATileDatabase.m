@@ -26,6 +26,7 @@ TileID TileOppositeCorner( TileID t ) {
 @synthesize minzoom;
 @synthesize maxzoom;
 @synthesize googleTileConvention;
+@synthesize format;
 
 - (double)resolutionAtZoom:(NSUInteger)zoom {
     int tilecount = 1 << zoom;  // fast way to calc 2 ^ zoom
@@ -105,8 +106,8 @@ TileID TileOppositeCorner( TileID t ) {
         tile.y = tilecount - 1 - tile.y;
     }
     
-    // pick base string at random
-    NSUInteger urlIndex = rand() % baseUrlStrings.count;
+    // spread tiles over the hosts, but always ask the same host for a tile so the URL cache can hit
+    NSUInteger urlIndex = ( tile.x + tile.y + tile.z ) % baseUrlStrings.count;
     NSMutableString * urlString = [[self.baseUrlStrings objectAtIndex:urlIndex] mutableCopy];
     
     [urlString replaceOccurrencesOfString:@"{x}" withString:[NSString stringWithFormat:@"%d", tile.x] options:NSCaseInsensitiveSearch range:NSMakeRange(0, [urlString length])];
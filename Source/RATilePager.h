@@ -15,6 +15,8 @@
 #import "RAGroup.h"
 #import "RAGeometry.h"
 #import "RACamera.h"
+#import "RAUploadScheduler.h"
+#import "RAImageryLayer.h"
 
 extern NSString * RATilePagerContentChangedNotification;
 
@@ -23,13 +25,46 @@ extern NSString * RATilePagerContentChangedNotification;
 
 @property (strong) RATileDatabase * imageryDatabase;
 @property (strong) RATileDatabase * terrainDatabase;
+@property (copy, nonatomic) NSArray * overlays;     // RAImageryLayers drawn over the imagery in order, set before the first update
 @property (strong) EAGLContext * auxilliaryContext;
 
 @property (readonly) NSSet * rootPages;
-@property (strong) RACamera * camera;
+@property (strong) RACamera * camera;                // the primary view
+@property (readonly) NSArray * cameras;             // every view paged for, primary first
+
+@property (assign) NSUInteger prefetchTileBudget;   // max tiles requested for each prediction
+@property (assign) NSUInteger prefetchByteBudget;   // max bytes held in the prefetch cache
+@property (assign) NSUInteger prefetchBandwidthBudget;  // max bytes prefetched per second
+@property (readonly) NSString * statsString;
+@property (readonly) RAUploadScheduler * uploadScheduler;
+@property (readonly) float minimumTerrainHeight;    // no terrain lies further below the ellipsoid, in ecef units
 
 - (void)setupPages;  // call once the databases are configured
 - (void)setupGL;
 - (void)requestUpdate;
+- (void)processUploads;     // call once per frame from within the rendering context
+
+// page for another view as well; one traversal loads what the most demanding view needs,
+// and each view picks its pages from the shared tree with its own RARenderVisitor;
+// the threshold is in texels of screen-space error and must be positive
+- (void)addCamera:(RACamera *)camera withErrorThreshold:(float)threshold;
+- (void)removeCamera:(RACamera *)camera;
+
+// the resident tiles, so that the next launch can reload them from the url cache before its first traversal
+- (BOOL)saveSnapshotToFile:(NSString *)path;
+- (NSUInteger)restoreSnapshotFromFile:(NSString *)path;    // call after setupPages, returns the number of tiles restored
+
+// fetch tiles for predicted camera positions at low priority, most important camera first
+- (void)prefetchForCameras:(NSArray *)cameras;
+
+#if DEBUG
+// logs how many tiles the primary view would draw with height-aware tile bounds and with
+// the old ellipsoid ones; walks the whole tree, so call it by hand when profiling
+- (void)logBoundComparison;
+#endif
+
+// nearest hits of ecef segments with the finest resident terrain, call from the main thread
+- (BOOL)intersectTerrainFrom:(GLKVector3)start to:(GLKVector3)end hit:(GLKVector3 *)hit;
+- (NSUInteger)intersectTerrainWithSegments:(NSUInteger)count from:(const GLKVector3 *)starts to:(const GLKVector3 *)ends hits:(GLKVector3 *)hits found:(BOOL *)found;
 
 @end
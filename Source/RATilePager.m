@@ -11,7 +11,9 @@
 #import "RAGeographicUtils.h"
 #import "RAPage.h"
 #import "RAPageNode.h"
-#import "RAImageSampler.h"
+#import "RATerrainTile.h"
+#import "RATextureAtlas.h"
+#import "RAMeshAtlas.h"
 
 #import <Foundation/Foundation.h>
 #import <GLKit/GLKVector2.h>
@@ -19,25 +21,157 @@
 
 NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNotification";
 
+static NSString * kPrefetchImageryPrefix = @"imagery";
+static NSString * kPrefetchTerrainPrefix = @"terrain";
+static const NSTimeInterval kTimeoutInterval = 5.0f;
+static const NSTimeInterval kPrefetchBandwidthWindow = 1.0;    // seconds the bandwidth budget is measured over
+
+// terrain extrusion in ecef units
+static const float kTerrainScale = 0.015f;      // highest extrusion assumed before a tile's heights are known
+static const float kSkirtDepth = -0.0001f;
+
+// vertices along each side of a tile mesh, not counting the skirt
+static const int kMeshGridSize = 32;
+
+static const float kVisibleUploadPriority = 1e6f;
+static const float kMinErrorThreshold = 0.5f;      // texels; below this a view would refine without end
+
+// one resident tile in a snapshot
+typedef struct {
+    uint32_t    x;
+    uint32_t    y;
+    uint8_t     z;
+    uint8_t     flags;
+    uint16_t    reserved;
+} RASnapshotTile;
+
+enum {
+    kSnapshotImagery = 1 << 0,
+    kSnapshotTerrain = 1 << 1,
+    kSnapshotOverlay = 1 << 2      // shifted by the overlay's index
+};
+
+static const int kSnapshotVersion = 2;
+
+// the base imagery and its overlays
+#define kMaxImageryLayers (1 + kRAMaxImageryOverlays)
+
+// tile images share atlas textures, so neighbouring tiles can be drawn together
+static const GLuint kAtlasPageSize = 2048;
+static const GLuint kAtlasSlotSize = 256;
+
+@class RAPagerView;
+
 @interface RATilePager (PrivateMethods)
+- (RAPage *)makePageForTile:(TileID)t withParent:(RAPage *)parent;
 - (RAPage *)makeLeafPageForTile:(TileID)t withParent:(RAPage *)parent;
+- (void)preparePageForTraversal:(RAPage *)page;
+- (RABoundingSphere)boundForTile:(TileID)t minHeight:(float)minHeight maxHeight:(float)maxHeight;
+- (float)heightMarginForTile:(TileID)t samples:(NSUInteger)samples;
+- (BOOL)page:(RAPage *)page needsDetailForView:(RAPagerView *)view;
+- (BOOL)page:(RAPage *)page exceedsErrorForView:(RAPagerView *)view;
 - (void)traverse;
+- (void)gatherPrefetchTilesForCameras:(NSArray *)cameras generation:(NSUInteger)generation;
+- (BOOL)chargePrefetchBytes:(NSUInteger)bytes;
+- (void)intersectPage:(RAPage *)page withSegments:(NSUInteger *)indices count:(NSUInteger)count from:(const GLKVector3 *)starts to:(const GLKVector3 *)ends fractions:(float *)fractions;
+- (RATextureWrapper *)textureWithPixelData:(NSData *)pixels width:(GLuint)width height:(GLuint)height;
+- (void)uploadGeometry:(RAGeometry *)geometry;
+- (RATileDatabase *)databaseForLayer:(NSUInteger)layer;
+- (BOOL)isLayer:(NSUInteger)layer visibleAtZoom:(NSUInteger)zoom;
+@end
+
+// a camera paged for, and how much error it tolerates
+@interface RAPagerView : NSObject
+@property (strong) RACamera * camera;
+@property (assign) float errorThreshold;
+@end
+
+@implementation RAPagerView
+@synthesize camera = _camera, errorThreshold = _errorThreshold;
+@end
+
+// a prefetch download, charged against the bandwidth budget as its bytes arrive
+@interface RAPrefetchLoad : NSObject <NSURLConnectionDataDelegate>
+@property (weak) RATilePager * pager;
+@property (strong) NSMutableData * data;
+@property (strong) NSURLResponse * response;
+@property (assign) BOOL finished;
+@property (assign) BOOL failed;
+@property (assign) BOOL overBudget;
+@end
+
+@implementation RAPrefetchLoad
+@synthesize pager = _pager, data = _data, response = _response;
+@synthesize finished = _finished, failed = _failed, overBudget = _overBudget;
+
+- (void)connection:(NSURLConnection *)connection didReceiveResponse:(NSURLResponse *)response {
+    self.response = response;
+    self.data = [NSMutableData data];
+}
+
+- (void)connection:(NSURLConnection *)connection didReceiveData:(NSData *)data {
+    [self.data appendData:data];
+    
+    if ( ! [self.pager chargePrefetchBytes:[data length]] ) {
+        [connection cancel];
+        self.overBudget = YES;
+        self.finished = YES;
+    }
+}
+
+- (void)connectionDidFinishLoading:(NSURLConnection *)connection {
+    self.finished = YES;
+}
+
+- (void)connection:(NSURLConnection *)connection didFailWithError:(NSError *)error {
+    self.failed = YES;
+    self.finished = YES;
+}
+
 @end
 
+
 @implementation RATilePager {
     RATextureWrapper *      _defaultTexture;
+    RATextureWrapper *      _clearTexture;
+    NSArray *               _overlays;
+    RATextureAtlas *        _textureAtlas;
+    RAMeshAtlas *           _meshAtlas;
         
     NSOperationQueue *      _updateQueue;
     NSOperationQueue *      _connectionQueue;
     NSOperationQueue *      _graphicsQueue;
+    NSOperationQueue *      _prefetchQueue;
     
     BOOL                    _traversing;
     BOOL                    _traverseAgain;
     
     NSSet *                 _rootPages;
+    NSObject *              _pageTreeLock;      // held to add or prune children, and by walks off the update queue
+    
+    NSMutableArray *        _views;
+    NSArray *               _traversalViews;
+    
+    NSCache *               _prefetchCache;
+    NSUInteger              _prefetchGeneration;
+    NSUInteger              _prefetchHits;
+    NSUInteger              _prefetchBytes;
+    NSTimeInterval          _prefetchWindowStart;
+    NSUInteger              _prefetchWindowBytes;
+    
+    NSUInteger              _restoreRequests;
+    NSUInteger              _restorePending;
+    NSUInteger              _restoreHits;
+    NSTimeInterval          _restoreStartTime;
+    
+    RAUploadScheduler *     _uploadScheduler;
+    BOOL                    _contentChangePending;
 }
 
-@synthesize imageryDatabase, terrainDatabase, auxilliaryContext, camera;
+@synthesize imageryDatabase, terrainDatabase, auxilliaryContext;
+@synthesize overlays = _overlays;
+@synthesize prefetchTileBudget, prefetchBandwidthBudget;
+@synthesize uploadScheduler = _uploadScheduler;
 
 - (id)init
 {
@@ -54,11 +188,30 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
         _graphicsQueue = [[NSOperationQueue alloc] init];
         [_graphicsQueue setName:@"org.dancingrobots.graphicsqueue"];
         [_graphicsQueue setMaxConcurrentOperationCount: 1];
+        
+        // keep prefetching from competing with visible tiles for bandwidth
+        _prefetchQueue = [[NSOperationQueue alloc] init];
+        [_prefetchQueue setName:@"org.dancingrobots.prefetchqueue"];
+        [_prefetchQueue setMaxConcurrentOperationCount: 2];
+        
+        _prefetchCache = [[NSCache alloc] init];
+        [_prefetchCache setName:@"org.dancingrobots.prefetchcache"];
+        
+        self.prefetchTileBudget = 64;
+        self.prefetchByteBudget = 8*1024*1024;
+        self.prefetchBandwidthBudget = 256*1024;
+        
+        _pageTreeLock = [NSObject new];
+        
+        _uploadScheduler = [RAUploadScheduler new];
+        _views = [NSMutableArray array];
     }
     return self;
 }
 
 - (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    
     [_updateQueue cancelAllOperations];
     [_updateQueue waitUntilAllOperationsAreFinished];
 
@@ -67,6 +220,112 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
 
     [_graphicsQueue cancelAllOperations];
     [_graphicsQueue waitUntilAllOperationsAreFinished];
+
+    [_prefetchQueue cancelAllOperations];
+    [_prefetchQueue waitUntilAllOperationsAreFinished];
+    
+    [_uploadScheduler cancelAllUploads];
+}
+
+- (RACamera *)camera {
+    @synchronized(_views) {
+        return ( _views.count > 0 ) ? [[_views objectAtIndex:0] camera] : nil;
+    }
+}
+
+- (void)setCamera:(RACamera *)camera {
+    @synchronized(_views) {
+        if ( _views.count > 0 ) [_views removeObjectAtIndex:0];
+        if ( camera == nil ) return;
+        
+        RAPagerView * view = [RAPagerView new];
+        view.camera = camera;
+        view.errorThreshold = kRADefaultErrorThreshold;
+        [_views insertObject:view atIndex:0];
+    }
+}
+
+- (NSArray *)cameras {
+    @synchronized(_views) {
+        return [_views valueForKey:@"camera"];
+    }
+}
+
+- (void)addCamera:(RACamera *)camera withErrorThreshold:(float)threshold {
+    NSAssert( self.camera != nil, @"set the primary camera first" );
+    NSAssert( threshold > 0.0f, @"the error threshold must be positive" );
+    
+    RAPagerView * view = [RAPagerView new];
+    view.camera = camera;
+    view.errorThreshold = MAX( threshold, kMinErrorThreshold );
+    
+    @synchronized(_views) {
+        [_views addObject:view];
+    }
+}
+
+- (void)removeCamera:(RACamera *)camera {
+    @synchronized(_views) {
+        // the primary view goes through the camera property
+        for( NSUInteger idx = 1; idx < _views.count; idx++ ) {
+            if ( [[_views objectAtIndex:idx] camera] == camera ) {
+                [_views removeObjectAtIndex:idx];
+                return;
+            }
+        }
+    }
+}
+
+- (void)setOverlays:(NSArray *)overlays {
+    NSAssert( [overlays count] <= kRAMaxImageryOverlays, @"too many imagery overlays" );
+    
+    // pages keep their overlay imagery by index, so the stack can't change once they load
+    for( RAImageryLayer * overlay in _overlays ) {
+        [[NSNotificationCenter defaultCenter] removeObserver:self name:RAImageryLayerVisibilityChangedNotification object:overlay];
+    }
+    _overlays = [overlays copy];
+    for( RAImageryLayer * overlay in _overlays ) {
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(overlayVisibilityChanged:) name:RAImageryLayerVisibilityChangedNotification object:overlay];
+    }
+}
+
+- (void)overlayVisibilityChanged:(NSNotification *)notification {
+    // fading out needs nothing, the shader hides the layer at zero opacity
+    if ( [[notification object] opacity] <= 0.0f ) return;
+    
+    // meshes built while the layer was transparent have the clear texture in its place, so
+    // rebuild them; the traversal then requests the layer's tiles for the visible pages
+    @synchronized(_pageTreeLock) {
+        NSMutableArray * open = [NSMutableArray arrayWithArray:[_rootPages allObjects]];
+        
+        while( open.count > 0 ) {
+            RAPage * page = [open lastObject];
+            [open removeLastObject];
+            
+            if ( page.geometryState == Complete || page.geometryState == Uploading ) page.geometryState = NeedsUpdate;
+            
+            if ( page.child1 ) [open addObject:page.child1];
+            if ( page.child2 ) [open addObject:page.child2];
+            if ( page.child3 ) [open addObject:page.child3];
+            if ( page.child4 ) [open addObject:page.child4];
+        }
+    }
+    
+    [self requestUpdate];
+}
+
+- (NSUInteger)imageryLayerCount {
+    return 1 + [self.overlays count];
+}
+
+- (RATileDatabase *)databaseForLayer:(NSUInteger)layer {
+    if ( layer == 0 ) return self.imageryDatabase;
+    return [[self.overlays objectAtIndex:layer-1] database];
+}
+
+- (BOOL)isLayer:(NSUInteger)layer visibleAtZoom:(NSUInteger)zoom {
+    if ( layer == 0 ) return YES;
+    return [[self.overlays objectAtIndex:layer-1] isVisibleAtZoom:zoom];
 }
 
 - (void)setupPages {
@@ -95,6 +354,30 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
     return _rootPages;
 }
 
+- (NSUInteger)prefetchByteBudget {
+    return [_prefetchCache totalCostLimit];
+}
+
+- (void)setPrefetchByteBudget:(NSUInteger)budget {
+    [_prefetchCache setTotalCostLimit:budget];
+}
+
+- (float)minimumTerrainHeight {
+    // the same limit the tile bounds are clamped to
+    return -kTerrainScale;
+}
+
+- (NSString *)statsString {
+    NSUInteger prefetchHits, prefetchBytes;
+    @synchronized(_prefetchCache) {
+        prefetchHits = _prefetchHits;
+        prefetchBytes = _prefetchBytes;
+    }
+    
+    return [NSString stringWithFormat:@"%lu pages, %lu prefetch hits, %lu KB prefetched, %@",
+            (unsigned long)[RAPage count], (unsigned long)prefetchHits, (unsigned long)( prefetchBytes / 1024 ), _uploadScheduler.statsString];
+}
+
 - (void)setupGL {
     // load the default "grid" texture
     if ( _defaultTexture == nil ) {
@@ -103,32 +386,94 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
         UIImage * gridImage = [UIImage imageNamed:@"grid256"];
         _defaultTexture = [[RATextureWrapper alloc] initWithImage:gridImage];
         
+        // overlays without a tile for a page sample nothing
+        NSData * clearPixel = [NSMutableData dataWithLength:4];
+        _clearTexture = [[RATextureWrapper alloc] initWithPixelData:clearPixel width:1 height:1];
+        
         glFlush();
         [EAGLContext setCurrentContext: nil];
     }
 }
 
 - (void)contentUpdated {
-    [[NSNotificationCenter defaultCenter] postNotificationName:RATilePagerContentChangedNotification object:self];
+    // a burst of finished tiles only posts one notification, on the main thread
+    @synchronized(self) {
+        if ( _contentChangePending ) return;
+        _contentChangePending = YES;
+    }
+    
+    __block RATilePager * mySelf = self;
+    [[NSOperationQueue mainQueue] addOperationWithBlock:^{
+        @synchronized(mySelf) {
+            mySelf->_contentChangePending = NO;
+        }
+        [[NSNotificationCenter defaultCenter] postNotificationName:RATilePagerContentChangedNotification object:mySelf];
+    }];
+}
+
+- (float)uploadPriorityForPage:(RAPage *)page {
+    // pruned while waiting
+    if ( page == nil ) return -1.0f;
+    
+    NSArray * views = nil;
+    @synchronized(_views) {
+        views = [_views copy];
+    }
+    
+    // visible tiles first, then the ones furthest from their ideal detail, in whichever view needs them most
+    float priority = 0.0f;
+    for( RAPagerView * view in views ) {
+        float viewPriority = [page calculateScreenSpaceErrorWithCamera:view.camera] / view.errorThreshold;
+        if ( [page isOnscreenWithCamera:view.camera] ) viewPriority += kVisibleUploadPriority;
+        priority = MAX( priority, viewPriority );
+    }
+    return priority;
+}
+
+- (void)processUploads {
+    [_uploadScheduler processUploads];
+}
+
+- (RATextureWrapper *)textureWithPixelData:(NSData *)pixels width:(GLuint)width height:(GLuint)height {
+    if ( _textureAtlas == nil )
+        _textureAtlas = [[RATextureAtlas alloc] initWithPageSize:kAtlasPageSize slotWidth:kAtlasSlotSize slotHeight:kAtlasSlotSize];
+    
+    // odd sized images get a texture of their own
+    RATextureWrapper * texture = [_textureAtlas textureWithPixelData:pixels width:width height:height];
+    if ( texture == nil ) texture = [[RATextureWrapper alloc] initWithPixelData:pixels width:width height:height];
+    return texture;
+}
+
+- (void)uploadGeometry:(RAGeometry *)geometry {
+    // every tile mesh has the same topology, so the first one sets up the atlas
+    if ( _meshAtlas == nil ) _meshAtlas = [[RAMeshAtlas alloc] initWithTemplate:geometry];
+    
+    if ( [_meshAtlas addGeometry:geometry] ) {
+        [geometry releaseClientData];
+    } else {
+        [geometry setupGL];
+    }
 }
 
-- (RAGeometry *)createGeometryForTile:(TileID)tile
+- (RAGeometry *)createGeometryForTile:(TileID)tile layerCount:(NSUInteger)layerCount
 {
-    // create geometry node
+    // create geometry node, each imagery layer has its own tex coords after the normal
     RAGeometry * geom = [RAGeometry new];
     geom.positionOffset = (0*sizeof(GLfloat));
     geom.normalOffset = (3*sizeof(GLfloat));
-    geom.textureOffset = (6*sizeof(GLfloat));    
+    geom.textureOffset = (6*sizeof(GLfloat));
+    if ( layerCount > 1 ) geom.texture1Offset = (8*sizeof(GLfloat));
+    if ( layerCount > 2 ) geom.texture2Offset = (10*sizeof(GLfloat));
     return geom;
 }
 
-- (void)setupGeometry:(RAGeometry *)geom forPage:(RAPage *)page withTextureFromPage:(RAPage *)texPage withHeightFromPage:(RAPage *)hgtPage {
+- (void)setupGeometry:(RAGeometry *)geom forPage:(RAPage *)page withTexturePages:(NSArray *)texPages withHeightFromPage:(RAPage *)hgtPage {
     
     RAPolarCoordinate lowerLeft = [self.imageryDatabase tileLatLonOrigin:page.tile];
     RAPolarCoordinate upperRight = [self.imageryDatabase tileLatLonOrigin:TileOppositeCorner(page.tile)];
     
     // use more precision for large tiles
-    const int gridSize = 32;
+    const int gridSize = kMeshGridSize;
     const int border = 1;
     const int totalSize = gridSize + border + border;
     const int indexSize = totalSize - 1;
@@ -140,19 +485,42 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
     // fits in index value?
     NSAssert( gridSize*gridSize < 65535, @"too many grid elements" );
 
-    const NSUInteger vertexElements = 8;
+    const NSUInteger layerCount = [texPages count];
+    const NSUInteger vertexElements = 6 + 2*layerCount;
     size_t vertexDataSize = vertexElements*sizeof(GLfloat) * totalSize*totalSize;
-    GLfloat * vertexData = (GLfloat *)calloc(totalSize*totalSize, vertexElements*sizeof(GLfloat));
+    RAMeshBuffer * vertexBuffer = [[RABufferPool sharedPool] bufferWithLength:vertexDataSize];
+    GLfloat * vertexData = (GLfloat *)vertexBuffer.bytes;
     
     const NSUInteger indexElements = 6;
     size_t indexDataSize = indexElements*sizeof(GLushort) * indexSize*indexSize;
-    GLushort * indexData = (GLushort *)calloc(indexSize*indexSize, indexElements*sizeof(GLushort));
+    RAMeshBuffer * indexBuffer = [[RABufferPool sharedPool] bufferWithLength:indexDataSize];
+    GLushort * indexData = (GLushort *)indexBuffer.bytes;
     
-    RAImageSampler * sampler = [[RAImageSampler alloc] initWithImage:hgtPage.terrain];
+    RATerrainTile * terrain = hgtPage.terrain;
+    
+    // where each layer's image sits within its texture, layers without one get zero tex coords
+    RATileDatabase * texDatabases[kMaxImageryLayers];
+    TileID texTiles[kMaxImageryLayers];
+    GLKVector4 texRects[kMaxImageryLayers];
+    BOOL texValid[kMaxImageryLayers];
+    
+    NSAssert( layerCount >= 1 && layerCount <= kMaxImageryLayers, @"unexpected number of imagery layers" );
+    for( NSUInteger layer = 0; layer < layerCount; layer++ ) {
+        id entry = [texPages objectAtIndex:layer];
+        texValid[layer] = ( entry != [NSNull null] );
+        if ( ! texValid[layer] ) continue;
+        
+        RAPage * texPage = entry;
+        RATextureWrapper * texture = [texPage imageryForLayer:layer];
+        texDatabases[layer] = [self databaseForLayer:layer];
+        texTiles[layer] = texPage.tile;
+        texRects[layer] = texture ? texture.textureRect : GLKVector4Make( 0, 0, 1, 1 );
+    }
         
     size_t vertexDataPos = 0;
     size_t indexDataPos = 0;
     BOOL isPartOfSkirt = NO;
+    float minExtrude = kSkirtDepth, maxExtrude = 0.0f;
 
     // calculate mesh vertices and indices
     for( int gy = 0; gy < totalSize; gy++ ) {
@@ -178,7 +546,22 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
             gpos.height = lowerLeft.height;
 
             GLKVector3 ecef = ConvertPolarToEcef(gpos);
-            GLKVector2 tex = [self.imageryDatabase textureCoordsForLatLon:gpos inTile:texPage.tile];
+            
+            for( NSUInteger layer = 0; layer < layerCount; layer++ ) {
+                GLKVector2 tex = GLKVector2Make( 0.0f, 0.0f );
+                
+                if ( texValid[layer] ) {
+                    tex = [texDatabases[layer] textureCoordsForLatLon:gpos inTile:texTiles[layer]];
+                    
+                    // skirts reach just past the tile, keep them from sampling a neighbouring atlas slot
+                    GLKVector4 texRect = texRects[layer];
+                    tex.x = texRect.x + texRect.z * MIN( MAX( tex.x, 0.0f ), 1.0f );
+                    tex.y = texRect.y + texRect.w * MIN( MAX( tex.y, 0.0f ), 1.0f );
+                }
+                
+                vertexData[vertexDataPos+6+2*layer] = tex.x;
+                vertexData[vertexDataPos+7+2*layer] = tex.y;
+            }
             
             GLKVector3 normal = GLKVector3Normalize(ecef);
             
@@ -186,13 +569,13 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
             float extrude = 0.0f;
             
             if ( isPartOfSkirt ) {
-                extrude = -0.0001f;    // skirt
-            } else if ( sampler ) {
-                GLKVector2 hgtPixel = [self.terrainDatabase textureCoordsForLatLon:gpos inTile:hgtPage.tile];
-
-                CGPoint p = CGPointMake((sampler.width-1) * hgtPixel.x, 
-                                        (sampler.height-1) * hgtPixel.y );
-                extrude = 0.015f * [sampler grayByInterpolatingPixels:p];
+                extrude = kSkirtDepth;
+            } else if ( terrain ) {
+                GLKVector2 hgtCoords = [self.terrainDatabase textureCoordsForLatLon:gpos inTile:hgtPage.tile];
+                extrude = ConvertHeightToEcef( [terrain heightAtTextureCoords:hgtCoords] );
+                
+                minExtrude = MIN( minExtrude, extrude );
+                maxExtrude = MAX( maxExtrude, extrude );
             }
             
             ecef = GLKVector3Add( ecef, GLKVector3MultiplyScalar(normal, extrude) );
@@ -205,9 +588,6 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
             vertexData[vertexDataPos+3] = normal.x;
             vertexData[vertexDataPos+4] = normal.y;
             vertexData[vertexDataPos+5] = normal.z;
-
-            vertexData[vertexDataPos+6] = tex.x;
-            vertexData[vertexDataPos+7] = tex.y;
             
             if ( gx < indexSize && gy < indexSize ) {
                 GLushort baseElement = gy*totalSize + gx;
@@ -263,11 +643,24 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
         }
     }
     
-    [geom setObjectData:vertexData withSize:vertexDataSize withStride:(vertexElements*sizeof(GLfloat))];
-    [geom setIndexData:indexData withSize:indexDataSize withStride:sizeof(GLushort)];
+    // the geometry takes the pooled buffers as they are
+    [geom setObjectBuffer:vertexBuffer withStride:(vertexElements*sizeof(GLfloat))];
+    [geom setIndexBuffer:indexBuffer withStride:sizeof(GLushort)];
     
-    free( vertexData );
-    free( indexData );
+    // tighten the page bound to the heights actually in the mesh, and index its surface for picking;
+    // the bound also holds the descendants, whose finer terrain can rise between this mesh's samples
+    if ( terrain ) {
+        float margin = MAX( [self heightMarginForTile:page.tile samples:gridSize], [self heightMarginForTile:hgtPage.tile samples:terrain.width] );
+        page.minHeight = MAX( minExtrude - margin, -kTerrainScale );
+        page.maxHeight = MIN( maxExtrude + margin, kTerrainScale );
+        page.bound = [self boundForTile:page.tile minHeight:page.minHeight maxHeight:page.maxHeight];
+        
+        page.heightField = [[RAHeightField alloc] initWithVertices:(vertexData + border*rowOffset + border*vertexElements)
+                                                             width:gridSize height:gridSize
+                                                      vertexStride:vertexElements rowStride:rowOffset];
+    } else {
+        page.heightField = nil;
+    }
 }
 
 - (void)updatePageIfNeeded:(RAPage *)page {
@@ -277,23 +670,51 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
     if ( page.geometryState == NotLoaded ) {
         NSAssert( page.geometry == nil, @"geometry must be nil if unloaded" );
         
-        page.geometry = [self createGeometryForTile:page.tile];
         page.geometryState = Loading;
-        
-        page.geometry.texture1 = _defaultTexture;
     }
     
     // update if needed
     if ( page.geometryState == NeedsUpdate || page.geometryState == Loading ) {
-        NSAssert( page.geometry != nil, @"geometry must be not nil if updating" );
+        // build into new geometry, so the page can keep drawing the old one until the upload
+        NSUInteger layerCount = [self imageryLayerCount];
+        RAGeometry * geometry = [self createGeometryForTile:page.tile layerCount:layerCount];
         
-        // find an ancestor tile with a valid texture
-        RAPage * imgAncestor = page;
-        while( imgAncestor ) {
-            // texture valid? use this page
-            if ( imgAncestor.imagery ) break;
+        // find an ancestor tile with a valid texture, for each layer on its own
+        NSMutableArray * texPages = [NSMutableArray arrayWithCapacity:layerCount];
+        for( NSUInteger layer = 0; layer < layerCount; layer++ ) {
+            RAPage * imgAncestor = nil;
             
-            imgAncestor = imgAncestor.parent;
+            if ( [self isLayer:layer visibleAtZoom:page.tile.z] ) {
+                imgAncestor = page;
+                while( imgAncestor ) {
+                    // texture valid? use this page
+                    if ( [imgAncestor imageryForLayer:layer] ) break;
+                    
+                    imgAncestor = imgAncestor.parent;
+                }
+            }
+            
+            [texPages addObject:( imgAncestor ? imgAncestor : [NSNull null] )];
+        }
+        
+        id baseEntry = [texPages objectAtIndex:0];
+        if ( baseEntry != [NSNull null] ) {
+            // recycle texture with appropriate tex coords
+            geometry.texture0 = [baseEntry imagery];
+        } else {
+            // show grid if necessary
+            [texPages replaceObjectAtIndex:0 withObject:page];
+            geometry.texture0 = _defaultTexture;
+        }
+        
+        // overlays are blended over it in the same draw, clear where they have no tile
+        if ( layerCount > 1 ) {
+            id entry = [texPages objectAtIndex:1];
+            geometry.texture1 = ( entry != [NSNull null] ) ? [entry imageryForLayer:1] : _clearTexture;
+        }
+        if ( layerCount > 2 ) {
+            id entry = [texPages objectAtIndex:2];
+            geometry.texture2 = ( entry != [NSNull null] ) ? [entry imageryForLayer:2] : _clearTexture;
         }
     
         RAPage * hgtAncestor = page;
@@ -304,38 +725,125 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
             hgtAncestor = hgtAncestor.parent;
         }
                     
-        if ( imgAncestor ) {
-            // recycle texture with appropriate tex coords
-            [self setupGeometry:page.geometry forPage:page withTextureFromPage:imgAncestor withHeightFromPage:hgtAncestor];
-            page.geometry.texture0 = imgAncestor.imagery;
-        } else {
-            // show grid if necessary
-            [self setupGeometry:page.geometry forPage:page withTextureFromPage:page withHeightFromPage:hgtAncestor];
-            page.geometry.texture0 = _defaultTexture;
-        }
+        [self setupGeometry:geometry forPage:page withTexturePages:texPages withHeightFromPage:hgtAncestor];
+        
+        page.geometryState = Uploading;
+        
+        // the scheduler drops the page if it is pruned before its turn
+        __block RATilePager * mySelf = self;
+        __weak RAPage * weakPage = page;
+        [_uploadScheduler addUploadWithBytes:geometry.dataSize priority:^float{
+            return [mySelf uploadPriorityForPage:weakPage];
+        } block:^{
+            RAPage * strongPage = weakPage;
+            if ( strongPage == nil ) return;
+            
+            [mySelf uploadGeometry:geometry];
+            strongPage.geometry = geometry;
             
-        page.geometryState = Complete;
-        [self contentUpdated];
+            // newer content may have arrived while this was queued
+            if ( strongPage.geometryState == Uploading ) strongPage.geometryState = Complete;
+            [mySelf contentUpdated];
+        }];
     }
 }
 
-- (void)requestPage:(RAPage *)page {
-    NSAssert( page != nil, @"the requested page must be valid");
-    const NSTimeInterval kTimeoutInterval = 5.0f;
+- (void)loadImageryData:(NSData *)data forPage:(RAPage *)page layer:(NSUInteger)layer fromURL:(NSURL *)url {
+    __block RATilePager * mySelf = self;
+    
+    [_graphicsQueue addOperationWithBlock:^{
+        UIImage * image = [UIImage imageWithData:data];
+        if ( image == nil ) {
+            NSLog(@"Bad image for URL: %@", url);
+            [page setImageryState:Failed forLayer:layer];
+            return;
+        }
+        
+        // decode here, only the texture upload itself waits for a frame
+        GLuint width = 0, height = 0;
+        NSData * pixels = [RATextureWrapper pixelDataForImage:image width:&width height:&height];
+        
+        __weak RAPage * weakPage = page;
+        [mySelf.uploadScheduler addUploadWithBytes:[pixels length] priority:^float{
+            return [mySelf uploadPriorityForPage:weakPage];
+        } block:^{
+            RAPage * strongPage = weakPage;
+            if ( strongPage == nil ) return;
+            
+            // create texture, every layer shares the atlas
+            RATextureWrapper * texture = [mySelf textureWithPixelData:pixels width:width height:height];
+            [strongPage setImagery:texture forLayer:layer];
+            [strongPage setImageryState:Complete forLayer:layer];
+            
+            // mark the geometry to get refreshed
+            strongPage.geometryState = NeedsUpdate;
+            [mySelf contentUpdated];
+        }];
+    }];
+}
+
+- (void)loadTerrainData:(NSData *)data forPage:(RAPage *)page fromURL:(NSURL *)url {
+    __block RATilePager * mySelf = self;
     
+    [_updateQueue addOperationWithBlock:^{
+        // decode once, every mesh built from this tile samples the same heights
+        RATerrainTile * terrain = nil;
+        if ( mySelf.terrainDatabase.format == RATileFormatTerrain ) {
+            terrain = [[RATerrainTile alloc] initWithData:data];
+        } else {
+            terrain = [[RATerrainTile alloc] initWithImage:[UIImage imageWithData:data]];
+        }
+        
+        if ( terrain == nil ) {
+            NSLog(@"Bad terrain for URL: %@", url);
+            page.terrainState = Failed;
+            return;
+        }
+        
+        page.terrain = terrain;
+        page.terrainState = Complete;
+
+        // mark the geometry to get refreshed
+        page.geometryState = NeedsUpdate;
+        [mySelf contentUpdated];
+    }];
+}
+
+- (NSString *)prefetchKeyForPage:(RAPage *)page layer:(NSUInteger)layer {
+    if ( layer == 0 ) return [kPrefetchImageryPrefix stringByAppendingString:page.key];
+    return [NSString stringWithFormat:@"%@%lu%@", kPrefetchImageryPrefix, (unsigned long)layer, page.key];
+}
+
+- (NSData *)takePrefetchedDataForKey:(NSString *)key {
+    NSData * data = [_prefetchCache objectForKey:key];
+    if ( data ) {
+        [_prefetchCache removeObjectForKey:key];
+        
+        @synchronized(_prefetchCache) {
+            _prefetchHits++;
+        }
+    }
+    return data;
+}
+
+- (void)requestImageryForPage:(RAPage *)page layer:(NSUInteger)layer {
     __block RATilePager * mySelf = self;
-                                    
+    
+    // pages outside a layer's zoom range, or under a transparent layer, neither load nor show it
+    if ( ! [self isLayer:layer visibleAtZoom:page.tile.z] ) return;
+    
     // request the tile image if needed
-    if ( page.imageryState == NotLoaded ) {
-        NSURL * url = [self.imageryDatabase urlForTile: page.tile];
+    if ( [page imageryStateForLayer:layer] == NotLoaded ) {
+        NSURL * url = [[self databaseForLayer:layer] urlForTile: page.tile];
+        NSData * prefetched = nil;
         
         if ( url == nil ) {
-            page.imageryState = Failed;
+            [page setImageryState:Failed forLayer:layer];
+        } else if ( ( prefetched = [self takePrefetchedDataForKey:[self prefetchKeyForPage:page layer:layer]] ) ) {
+            [page setImageryState:Loading forLayer:layer];
+            [self loadImageryData:prefetched forPage:page layer:layer fromURL:url];
         } else {
-            page.imageryState = Loading;
-            
-            // capture ivar locally to avoid retain cycle
-            NSOperationQueue * graphicsQueue = _graphicsQueue;
+            [page setImageryState:Loading forLayer:layer];
             
             NSURLRequest * request = [NSURLRequest requestWithURL:url cachePolicy:NSURLRequestUseProtocolCachePolicy timeoutInterval:kTimeoutInterval];
             
@@ -347,64 +855,56 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
                         switch( [error code] ) {
                             case NSURLErrorTimedOut:
                                 // attempt to reload if the connection timed out
-                                page.imageryState = NotLoaded;
+                                [page setImageryState:NotLoaded forLayer:layer];
                                 return;
                             case NSURLErrorNotConnectedToInternet:  // !!! catch other common errors here
                                 // give up if net access is unavailable
-                                page.imageryState = Failed;
+                                [page setImageryState:Failed forLayer:layer];
                                 return;
                             default: break;
                         }
                     }
 
                     NSLog(@"URL loading error: %@", error);
-                    page.imageryState = Failed;
+                    [page setImageryState:Failed forLayer:layer];
                     return;
                 } else if ( [[response MIMEType] isEqualToString:@"text/html"] ) {
                     NSString * content = [[NSString alloc] initWithData:data encoding:NSASCIIStringEncoding];
                     NSLog(@"Request Returned: %@", content);
-                    page.imageryState = Failed;
+                    [page setImageryState:Failed forLayer:layer];
                     return;
                 }
                 
-                [graphicsQueue addOperationWithBlock:^{
-                    [EAGLContext setCurrentContext: self.auxilliaryContext];
-                    
-                    UIImage * image = [UIImage imageWithData:data];
-                    if ( image == nil ) {
-                        NSLog(@"Bad image for URL: %@", url);
-                        page.imageryState = Failed;
-                        return;
-                    }
-                    
-                    // create texture
-                    RATextureWrapper * texture = [[RATextureWrapper alloc] initWithImage:image];
-                    page.imagery = texture;
-                    page.imageryState = Complete;
-                    
-                    // mark the geometry to get refreshed
-                    page.geometryState = NeedsUpdate;
-                    [mySelf contentUpdated];
-
-                    glFlush();
-                    [EAGLContext setCurrentContext: nil];
-                }];
+                [mySelf loadImageryData:data forPage:page layer:layer fromURL:url];
             }];
         }
     }
+}
+
+- (void)requestPage:(RAPage *)page {
+    NSAssert( page != nil, @"the requested page must be valid");
+    
+    __block RATilePager * mySelf = self;
+    
+    // each imagery layer loads on its own, through the same queues and caches
+    NSUInteger layerCount = [self imageryLayerCount];
+    for( NSUInteger layer = 0; layer < layerCount; layer++ ) {
+        [self requestImageryForPage:page layer:layer];
+    }
     
     // request the terrain if needed
     if ( page.terrainState == NotLoaded ) {
         NSURL * url = [self.terrainDatabase urlForTile: page.tile];
+        NSData * prefetched = nil;
         
         if ( url == nil ) {
             page.terrainState = Failed;
+        } else if ( ( prefetched = [self takePrefetchedDataForKey:[kPrefetchTerrainPrefix stringByAppendingString:page.key]] ) ) {
+            page.terrainState = Loading;
+            [self loadTerrainData:prefetched forPage:page fromURL:url];
         } else {
             page.terrainState = Loading;
 
-            // capture ivar locally to avoid retain cycle
-            NSOperationQueue * updateQueue = _updateQueue;
-
             NSURLRequest * request = [NSURLRequest requestWithURL:url cachePolicy:NSURLRequestUseProtocolCachePolicy timeoutInterval:kTimeoutInterval];
 
             [NSURLConnection sendAsynchronousRequest:request queue:_connectionQueue completionHandler:^(NSURLResponse* response, NSData* data, NSError* error)
@@ -435,35 +935,601 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
                     return;
                 }
                 
-                [updateQueue addOperationWithBlock:^{
-                    UIImage * image = [UIImage imageWithData:data];
-                    if ( image == nil ) {
-                        NSLog(@"Bad terrain for URL: %@", url);
-                        page.terrainState = Failed;
-                        return;
-                    }
+                [mySelf loadTerrainData:data forPage:page fromURL:url];
+            }];
+        }
+    }
+}
+
+#pragma mark Snapshot Methods
+
+- (NSString *)snapshotSourceForDatabase:(RATileDatabase *)database {
+    if ( database == nil ) return @"";
+    return [database.baseUrlStrings componentsJoinedByString:@" "];
+}
+
+- (NSString *)snapshotSourceForOverlays {
+    NSMutableArray * sources = [NSMutableArray array];
+    for( RAImageryLayer * overlay in self.overlays ) {
+        [sources addObject:[self snapshotSourceForDatabase:overlay.database]];
+    }
+    return [sources componentsJoinedByString:@"\n"];
+}
+
+- (uint8_t)snapshotFlagForLayer:(NSUInteger)layer {
+    return ( layer == 0 ) ? kSnapshotImagery : ( kSnapshotOverlay << ( layer - 1 ) );
+}
+
+- (BOOL)saveSnapshotToFile:(NSString *)path {
+    if ( _rootPages == nil ) return NO;
+    
+    NSMutableData * tiles = [NSMutableData data];
+    NSUInteger layerCount = [self imageryLayerCount];
+    
+    // called on the main thread as the app leaves, so don't wait out a traversal;
+    // the lock only keeps children from being added or pruned under the walk
+    @synchronized(_pageTreeLock) {
+        NSMutableArray * open = [NSMutableArray arrayWithArray:[_rootPages allObjects]];
+        
+        while( open.count > 0 ) {
+            RAPage * page = [open lastObject];
+            [open removeLastObject];
+            
+            uint8_t flags = 0;
+            for( NSUInteger layer = 0; layer < layerCount; layer++ ) {
+                if ( [page imageryStateForLayer:layer] == Complete ) flags |= [self snapshotFlagForLayer:layer];
+            }
+            if ( page.terrainState == Complete ) flags |= kSnapshotTerrain;
+            
+            if ( flags ) {
+                RASnapshotTile record = { page.tile.x, page.tile.y, page.tile.z, flags, 0 };
+                [tiles appendBytes:&record length:sizeof(record)];
+            }
+            
+            if ( page.child1 ) [open addObject:page.child1];
+            if ( page.child2 ) [open addObject:page.child2];
+            if ( page.child3 ) [open addObject:page.child3];
+            if ( page.child4 ) [open addObject:page.child4];
+        }
+    }
+    
+    NSDictionary * snapshot = [NSDictionary dictionaryWithObjectsAndKeys:
+                               [NSNumber numberWithInt:kSnapshotVersion], @"version",
+                               [self snapshotSourceForDatabase:self.imageryDatabase], @"imagery",
+                               [self snapshotSourceForOverlays], @"overlays",
+                               [self snapshotSourceForDatabase:self.terrainDatabase], @"terrain",
+                               tiles, @"tiles",
+                               nil];
+    
+    NSError * error = nil;
+    NSData * data = [NSPropertyListSerialization dataWithPropertyList:snapshot format:NSPropertyListBinaryFormat_v1_0 options:0 error:&error];
+    if ( data == nil ) {
+        NSLog(@"Can't serialize snapshot: %@", error);
+        return NO;
+    }
+    
+    return [data writeToFile:path atomically:YES];
+}
 
-                    page.terrain = image;
-                    page.terrainState = Complete;
+- (RAPage *)residentPageForTile:(TileID)t withRoots:(NSDictionary *)roots baseZoom:(NSUInteger)basezoom {
+    if ( t.z < basezoom || t.x >= ( 1u << t.z ) || t.y >= ( 1u << t.z ) ) return nil;
+    
+    TileID rootTile = { t.x >> ( t.z - basezoom ), t.y >> ( t.z - basezoom ), basezoom };
+    RAPage * page = [roots objectForKey:[NSString stringWithFormat:@"{%lu,%lu,%lu}", (unsigned long)rootTile.z, (unsigned long)rootTile.x, (unsigned long)rootTile.y]];
+    
+    // create the pages in between, as the traversal would have
+    for( NSUInteger level = basezoom + 1; page && level <= t.z; level++ ) {
+        NSUInteger shift = t.z - level;
+        NSUInteger quadrant = ( ( t.x >> shift ) & 1 ) + 2 * ( ( t.y >> shift ) & 1 );
+        
+        [self preparePageForTraversal:page];
+        switch( quadrant ) {
+            case 0: page = page.child1; break;
+            case 1: page = page.child2; break;
+            case 2: page = page.child3; break;
+            default: page = page.child4; break;
+        }
+    }
+    
+    return page;
+}
 
-                    // mark the geometry to get refreshed
-                    page.geometryState = NeedsUpdate;
-                    [mySelf contentUpdated];
+- (void)finishRestoreWithHit:(BOOL)hit {
+    @synchronized(self) {
+        if ( hit ) _restoreHits++;
+        if ( --_restorePending > 0 ) return;
+        
+        NSLog(@"Warm start: %lu of %lu tiles from cache in %.0f ms", (unsigned long)_restoreHits, (unsigned long)_restoreRequests,
+              1e3 * ( [NSDate timeIntervalSinceReferenceDate] - _restoreStartTime ));
+    }
+}
+
+- (void)restoreURL:(NSURL *)url completion:(void (^)(NSData * data))completion {
+    @synchronized(self) {
+        _restoreRequests++;
+        _restorePending++;
+    }
+    
+    // only what the url cache already holds, the network is left to the usual requests
+    NSURLRequest * request = [NSURLRequest requestWithURL:url cachePolicy:NSURLRequestReturnCacheDataDontLoad timeoutInterval:kTimeoutInterval];
+    
+    __block RATilePager * mySelf = self;
+    [NSURLConnection sendAsynchronousRequest:request queue:_connectionQueue completionHandler:^(NSURLResponse* response, NSData* data, NSError* error)
+    {
+        BOOL hit = ( error == nil && [data length] > 0 && ! [[response MIMEType] isEqualToString:@"text/html"] );
+        completion( hit ? data : nil );
+        [mySelf finishRestoreWithHit:hit];
+    }];
+}
+
+- (NSUInteger)restoreSnapshotFromFile:(NSString *)path {
+    NSData * data = [NSData dataWithContentsOfFile:path];
+    if ( data == nil || _rootPages == nil ) return 0;
+    
+    NSDictionary * snapshot = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:NULL];
+    if ( ! [snapshot isKindOfClass:[NSDictionary class]] || [[snapshot objectForKey:@"version"] intValue] != kSnapshotVersion ) return 0;
+    
+    // tiles from another data set would be wrong
+    if ( ! [[snapshot objectForKey:@"imagery"] isEqual:[self snapshotSourceForDatabase:self.imageryDatabase]] ) return 0;
+    if ( ! [[snapshot objectForKey:@"overlays"] isEqual:[self snapshotSourceForOverlays]] ) return 0;
+    if ( ! [[snapshot objectForKey:@"terrain"] isEqual:[self snapshotSourceForDatabase:self.terrainDatabase]] ) return 0;
+    
+    NSData * tiles = [snapshot objectForKey:@"tiles"];
+    if ( ! [tiles isKindOfClass:[NSData class]] ) return 0;
+    
+    const RASnapshotTile * records = (const RASnapshotTile *)[tiles bytes];
+    NSUInteger count = [tiles length] / sizeof(RASnapshotTile);
+    
+    NSMutableDictionary * roots = [NSMutableDictionary dictionaryWithCapacity:[_rootPages count]];
+    NSUInteger basezoom = NSUIntegerMax;
+    for( RAPage * page in _rootPages ) {
+        [roots setObject:page forKey:page.key];
+        basezoom = MIN( basezoom, page.tile.z );
+    }
+    
+    // the extra pending count is dropped once every request is issued, so early completions can't finish the restore
+    @synchronized(self) {
+        _restoreStartTime = [NSDate timeIntervalSinceReferenceDate];
+        _restoreRequests = _restoreHits = 0;
+        _restorePending = 1;
+    }
+    
+    __block RATilePager * mySelf = self;
+    NSUInteger restored = 0;
+    NSUInteger layerCount = [self imageryLayerCount];
+    
+    for( NSUInteger i = 0; i < count; i++ ) {
+        TileID t = { records[i].x, records[i].y, records[i].z };
+        if ( t.z > self.imageryDatabase.maxzoom ) continue;
+        
+        RAPage * page = [self residentPageForTile:t withRoots:roots baseZoom:basezoom];
+        if ( page == nil ) continue;
+        
+        // every tile loads at once, and the traversal won't request them again meanwhile
+        for( NSUInteger layer = 0; layer < layerCount; layer++ ) {
+            NSURL * imageryUrl = [[self databaseForLayer:layer] urlForTile:t];
+            if ( ( records[i].flags & [self snapshotFlagForLayer:layer] ) && imageryUrl && [page imageryStateForLayer:layer] == NotLoaded ) {
+                [page setImageryState:Loading forLayer:layer];
+                [self restoreURL:imageryUrl completion:^(NSData * data) {
+                    if ( data ) {
+                        [mySelf loadImageryData:data forPage:page layer:layer fromURL:imageryUrl];
+                    } else {
+                        [page setImageryState:NotLoaded forLayer:layer];
+                    }
                 }];
+            }
+        }
+        
+        NSURL * terrainUrl = [self.terrainDatabase urlForTile:t];
+        if ( ( records[i].flags & kSnapshotTerrain ) && terrainUrl && page.terrainState == NotLoaded ) {
+            page.terrainState = Loading;
+            [self restoreURL:terrainUrl completion:^(NSData * data) {
+                if ( data ) {
+                    [mySelf loadTerrainData:data forPage:page fromURL:terrainUrl];
+                } else {
+                    page.terrainState = NotLoaded;
+                }
             }];
         }
+        
+        restored++;
+    }
+    
+    [self finishRestoreWithHit:NO];
+    return restored;
+}
+
+#pragma mark Prefetch Methods
+
+- (void)prefetchForCameras:(NSArray *)cameras {
+    if ( cameras.count == 0 || _rootPages == nil ) return;
+    
+    // a newer prediction supersedes anything still queued
+    NSUInteger generation;
+    @synchronized(_prefetchCache) {
+        generation = ++_prefetchGeneration;
+    }
+    [_prefetchQueue cancelAllOperations];
+    
+    // capture self to avoid a retain cycle
+    __block RATilePager * mySelf = self;
+    
+    NSBlockOperation * operation = [NSBlockOperation blockOperationWithBlock:^{
+        [mySelf gatherPrefetchTilesForCameras:cameras generation:generation];
+    }];
+    [operation setQueuePriority:NSOperationQueuePriorityVeryLow];
+    [_prefetchQueue addOperation:operation];
+}
+
+- (BOOL)isCurrentPrefetchGeneration:(NSUInteger)generation {
+    @synchronized(_prefetchCache) {
+        return generation == _prefetchGeneration;
+    }
+}
+
+- (BOOL)pageNeedsImagery:(RAPage *)page {
+    NSUInteger layerCount = [self imageryLayerCount];
+    for( NSUInteger layer = 0; layer < layerCount; layer++ ) {
+        if ( [page imageryStateForLayer:layer] == NotLoaded && [self isLayer:layer visibleAtZoom:page.tile.z] ) return YES;
+    }
+    return NO;
+}
+
+- (void)addPrefetchChild:(RAPage *)child forTile:(TileID)t withParent:(RAPage *)parent toArray:(NSMutableArray *)open {
+    // resident children carry their load state; the rest are transient and never become part of the page tree
+    [open addObject:( child ? child : [self makePageForTile:t withParent:parent] )];
+}
+
+- (void)collectPrefetchPagesForCamera:(RACamera *)predicted threshold:(float)threshold intoArray:(NSMutableArray *)pages withKeys:(NSMutableSet *)keys limit:(NSUInteger)limit {
+    // breadth first, so coarse tiles are fetched before fine ones
+    NSMutableArray * open = [NSMutableArray arrayWithArray:[_rootPages allObjects]];
+    NSUInteger added = 0;
+    
+    while( open.count > 0 && added < limit ) {
+        RAPage * page = [open objectAtIndex:0];
+        [open removeObjectAtIndex:0];
+        
+        if ( page.tile.z > self.imageryDatabase.maxzoom ) continue;
+        if ( ! [page isOnscreenWithCamera:predicted] ) continue;
+        
+        float cosTheta = [page calculateTiltWithCamera:predicted];
+        if ( cosTheta < -0.5f || ( page.tile.z > 2 && cosTheta < 0.0f ) ) continue;
+        
+        // tiles already resident or on their way are skipped
+        if ( [self pageNeedsImagery:page] && ! [keys containsObject:page.key] ) {
+            [keys addObject:page.key];
+            [pages addObject:page];
+            added++;
+        }
+        
+        if ( [page calculateScreenSpaceErrorWithCamera:predicted] > threshold ) {
+            RAPage * child1, * child2, * child3, * child4;
+            @synchronized(_pageTreeLock) {
+                child1 = page.child1;
+                child2 = page.child2;
+                child3 = page.child3;
+                child4 = page.child4;
+            }
+            
+            [self addPrefetchChild:child1 forTile:(TileID){ 2*page.tile.x+0, 2*page.tile.y+0, page.tile.z+1 } withParent:page toArray:open];
+            [self addPrefetchChild:child2 forTile:(TileID){ 2*page.tile.x+1, 2*page.tile.y+0, page.tile.z+1 } withParent:page toArray:open];
+            [self addPrefetchChild:child3 forTile:(TileID){ 2*page.tile.x+0, 2*page.tile.y+1, page.tile.z+1 } withParent:page toArray:open];
+            [self addPrefetchChild:child4 forTile:(TileID){ 2*page.tile.x+1, 2*page.tile.y+1, page.tile.z+1 } withParent:page toArray:open];
+        }
+    }
+}
+
+- (BOOL)hasPrefetchBandwidth {
+    @synchronized(_prefetchCache) {
+        NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+        if ( now - _prefetchWindowStart >= kPrefetchBandwidthWindow ) {
+            _prefetchWindowStart = now;
+            _prefetchWindowBytes = 0;
+        }
+        return _prefetchWindowBytes < self.prefetchBandwidthBudget * kPrefetchBandwidthWindow;
+    }
+}
+
+- (BOOL)chargePrefetchBytes:(NSUInteger)bytes {
+    @synchronized(_prefetchCache) {
+        _prefetchWindowBytes += bytes;
+    }
+    return [self hasPrefetchBandwidth];
+}
+
+// returns NO once the bandwidth budget is spent, so the caller can stop its batch
+- (BOOL)prefetchURL:(NSURL *)url forKey:(NSString *)key {
+    if ( url == nil || [_prefetchCache objectForKey:key] ) return YES;
+    
+    // prefetching is opportunistic, tiles over the budget are left to the usual requests
+    if ( ! [self hasPrefetchBandwidth] ) return NO;
+    
+    NSURLRequest * request = [NSURLRequest requestWithURL:url cachePolicy:NSURLRequestUseProtocolCachePolicy timeoutInterval:kTimeoutInterval];
+    
+    // load on this operation's thread, so each piece is charged as it arrives
+    RAPrefetchLoad * load = [RAPrefetchLoad new];
+    load.pager = self;
+    
+    NSURLConnection * connection = [[NSURLConnection alloc] initWithRequest:request delegate:load startImmediately:NO];
+    [connection scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
+    [connection start];
+    
+    while( ! load.finished ) {
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate distantFuture]];
+    }
+    
+    // a partial tile is of no use, though its bytes still count against the budget
+    if ( load.overBudget ) return NO;
+    if ( load.failed || load.data == nil || [[load.response MIMEType] isEqualToString:@"text/html"] ) return YES;
+    
+    [_prefetchCache setObject:load.data forKey:key cost:[load.data length]];
+    
+    @synchronized(_prefetchCache) {
+        _prefetchBytes += [load.data length];
+    }
+    return YES;
+}
+
+- (void)cancelPrefetchGeneration:(NSUInteger)generation {
+    // under the lock, so a newer prediction's operations can't be caught up in it
+    @synchronized(_prefetchCache) {
+        if ( generation == _prefetchGeneration ) [_prefetchQueue cancelAllOperations];
+    }
+}
+
+- (void)gatherPrefetchTilesForCameras:(NSArray *)cameras generation:(NSUInteger)generation {
+    NSMutableArray * pages = [NSMutableArray array];
+    NSMutableSet * keys = [NSMutableSet set];
+    
+    // the destination gets half of the budget, the rest is spread along the path
+    NSUInteger budget = self.prefetchTileBudget;
+    NSUInteger pathLimit = ( cameras.count > 1 ) ? MAX( budget / ( 2 * ( cameras.count - 1 ) ), 1 ) : 0;
+    
+    // the predictions follow the primary view, so they refine as far as it would
+    float threshold = kRADefaultErrorThreshold;
+    @synchronized(_views) {
+        if ( _views.count > 0 ) threshold = [[_views objectAtIndex:0] errorThreshold];
+    }
+    
+    for( NSUInteger idx = 0; idx < cameras.count && pages.count < budget; idx++ ) {
+        if ( ! [self isCurrentPrefetchGeneration:generation] ) return;
+        
+        NSUInteger limit = ( idx == 0 ) ? MAX( budget / 2, 1 ) : pathLimit;
+        limit = MIN( limit, budget - pages.count );
+        [self collectPrefetchPagesForCamera:[cameras objectAtIndex:idx] threshold:threshold intoArray:pages withKeys:keys limit:limit];
+    }
+    
+    // capture self to avoid a retain cycle
+    __block RATilePager * mySelf = self;
+    
+    NSUInteger layerCount = [self imageryLayerCount];
+    
+    for( RAPage * page in pages ) {
+        NSMutableArray * imageryKeys = [NSMutableArray arrayWithCapacity:layerCount];
+        NSMutableArray * imageryUrls = [NSMutableArray arrayWithCapacity:layerCount];
+        for( NSUInteger layer = 0; layer < layerCount; layer++ ) {
+            if ( [page imageryStateForLayer:layer] != NotLoaded || ! [self isLayer:layer visibleAtZoom:page.tile.z] ) continue;
+            
+            NSURL * url = [[self databaseForLayer:layer] urlForTile:page.tile];
+            if ( url == nil ) continue;
+            
+            [imageryKeys addObject:[self prefetchKeyForPage:page layer:layer]];
+            [imageryUrls addObject:url];
+        }
+        
+        NSString * terrainKey = [kPrefetchTerrainPrefix stringByAppendingString:page.key];
+        NSURL * terrainUrl = ( page.terrainState == NotLoaded ) ? [self.terrainDatabase urlForTile:page.tile] : nil;
+        
+        NSBlockOperation * operation = [NSBlockOperation blockOperationWithBlock:^{
+            if ( ! [mySelf isCurrentPrefetchGeneration:generation] ) return;
+            
+            // once the budget runs out the rest of the batch is dropped
+            for( NSUInteger idx = 0; idx < imageryUrls.count; idx++ ) {
+                if ( ! [mySelf prefetchURL:[imageryUrls objectAtIndex:idx] forKey:[imageryKeys objectAtIndex:idx]] ) {
+                    [mySelf cancelPrefetchGeneration:generation];
+                    return;
+                }
+            }
+            if ( ! [mySelf prefetchURL:terrainUrl forKey:terrainKey] ) [mySelf cancelPrefetchGeneration:generation];
+        }];
+        [operation setQueuePriority:NSOperationQueuePriorityLow];
+        [_prefetchQueue addOperation:operation];
+    }
+}
+
+#pragma mark Picking Methods
+
+- (BOOL)intersectTerrainFrom:(GLKVector3)start to:(GLKVector3)end hit:(GLKVector3 *)hit {
+    BOOL found = NO;
+    [self intersectTerrainWithSegments:1 from:&start to:&end hits:hit found:&found];
+    return found;
+}
+
+- (NSUInteger)intersectTerrainWithSegments:(NSUInteger)count from:(const GLKVector3 *)starts to:(const GLKVector3 *)ends hits:(GLKVector3 *)hits found:(BOOL *)found {
+    if ( count == 0 ) return 0;
+    
+    NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
+    
+    NSUInteger * indices = (NSUInteger *)malloc( count * sizeof(NSUInteger) );
+    float * fractions = (float *)malloc( count * sizeof(float) );
+    for( NSUInteger i = 0; i < count; i++ ) {
+        indices[i] = i;
+        fractions[i] = 2.0f;    // no hit yet
+    }
+    
+    // every segment descends the page tree together, so shared pages are only tested once;
+    // the update queue adds and prunes children under the same lock
+    @synchronized(_pageTreeLock) {
+        for( RAPage * page in _rootPages ) {
+            [self intersectPage:page withSegments:indices count:count from:starts to:ends fractions:fractions];
+        }
+    }
+    
+    NSUInteger hitCount = 0;
+    for( NSUInteger i = 0; i < count; i++ ) {
+        BOOL isHit = ( fractions[i] <= 1.0f );
+        if ( isHit ) {
+            hitCount++;
+            if ( hits ) hits[i] = GLKVector3Add( starts[i], GLKVector3MultiplyScalar( GLKVector3Subtract(ends[i], starts[i]), fractions[i] ) );
+        }
+        if ( found ) found[i] = isHit;
+    }
+    
+    free( indices );
+    free( fractions );
+    
+    return hitCount;
+}
+
+- (void)intersectPage:(RAPage *)page withSegments:(NSUInteger *)indices count:(NSUInteger)count from:(const GLKVector3 *)starts to:(const GLKVector3 *)ends fractions:(float *)fractions {
+    // pages without terrain have no children with it either
+    RAHeightField * heightField = page.heightField;
+    if ( heightField == nil ) return;
+    
+    // move the segments that reach this page before their nearest hit so far to the front; the
+    // children only reorder that prefix, so the set stays intact for the tests below
+    RABoundingSphere bound = page.bound;
+    NSUInteger activeCount = 0;
+    for( NSUInteger i = 0; i < count; i++ ) {
+        NSUInteger s = indices[i];
+        float limit = MIN( fractions[s], 1.0f );
+        GLKVector3 end = GLKVector3Add( starts[s], GLKVector3MultiplyScalar( GLKVector3Subtract(ends[s], starts[s]), limit ) );
+        if ( RABoundingSphereIntersectsSegment( bound, starts[s], end ) ) {
+            indices[i] = indices[activeCount];
+            indices[activeCount++] = s;
+        }
+    }
+    if ( activeCount == 0 ) return;
+    
+    // prefer each child that has terrain, and use this page's surface where one doesn't
+    RAPage * children[4] = { page.child1, page.child2, page.child3, page.child4 };
+    BOOL missing[4];
+    int missingCount = 0;
+    for( int c = 0; c < 4; c++ ) {
+        missing[c] = ( children[c].heightField == nil );
+        if ( missing[c] ) {
+            missingCount++;
+        } else {
+            [self intersectPage:children[c] withSegments:indices count:activeCount from:starts to:ends fractions:fractions];
+        }
+    }
+    if ( missingCount == 0 ) return;
+    
+    RAPolarCoordinate lowerLeft = [self.imageryDatabase tileLatLonOrigin:page.tile];
+    RAPolarCoordinate upperRight = [self.imageryDatabase tileLatLonOrigin:TileOppositeCorner(page.tile)];
+    double columnScale = ( heightField.width - 1 ) / ( upperRight.longitude - lowerLeft.longitude );
+    double rowScale = ( heightField.height - 1 ) / ( upperRight.latitude - lowerLeft.latitude );
+    
+    for( int c = 0; c < 4; c++ ) {
+        if ( ! missing[c] ) continue;
+        
+        NSRange columns = NSMakeRange( 0, heightField.width - 1 );
+        NSRange rows = NSMakeRange( 0, heightField.height - 1 );
+        if ( missingCount < 4 ) {
+            // the cells under the child's quarter of the tile, rounded out to keep the ones on its edges
+            TileID t = { 2*page.tile.x + (c & 1), 2*page.tile.y + (c >> 1), page.tile.z+1 };
+            RAPolarCoordinate childLower = [self.imageryDatabase tileLatLonOrigin:t];
+            RAPolarCoordinate childUpper = [self.imageryDatabase tileLatLonOrigin:TileOppositeCorner(t)];
+            
+            NSInteger x0 = MAX( (NSInteger)floor( ( childLower.longitude - lowerLeft.longitude ) * columnScale ), 0 );
+            NSInteger x1 = MIN( (NSInteger)ceil( ( childUpper.longitude - lowerLeft.longitude ) * columnScale ), (NSInteger)columns.length );
+            NSInteger y0 = MAX( (NSInteger)floor( ( childLower.latitude - lowerLeft.latitude ) * rowScale ), 0 );
+            NSInteger y1 = MIN( (NSInteger)ceil( ( childUpper.latitude - lowerLeft.latitude ) * rowScale ), (NSInteger)rows.length );
+            if ( x1 <= x0 || y1 <= y0 ) continue;
+            
+            columns = NSMakeRange( x0, x1 - x0 );
+            rows = NSMakeRange( y0, y1 - y0 );
+        }
+        
+        for( NSUInteger i = 0; i < activeCount; i++ ) {
+            NSUInteger s = indices[i];
+            float fraction = MIN( fractions[s], 1.0f );
+            if ( [heightField intersectSegmentFrom:starts[s] to:ends[s] fraction:&fraction columns:columns rows:rows] ) fractions[s] = fraction;
+        }
+        
+        // with no children to defer to, the whole surface was tested at once
+        if ( missingCount == 4 ) break;
     }
 }
 
 #pragma mark Page Traversal Methods
 
-- (RAPage *)makeLeafPageForTile:(TileID)t withParent:(RAPage *)parent {
+- (RABoundingSphere)boundForTile:(TileID)t minHeight:(float)minHeight maxHeight:(float)maxHeight {
+    RAPolarCoordinate lowerLeft = [self.imageryDatabase tileLatLonOrigin:t];
+    RAPolarCoordinate upperRight = [self.imageryDatabase tileLatLonOrigin:TileOppositeCorner(t)];
+    
+    // sample the tile surface at both extremes of the height range
+    const int samples = 5;
+    double latInterval = ( upperRight.latitude - lowerLeft.latitude ) / (samples-1);
+    double lonInterval = ( upperRight.longitude - lowerLeft.longitude ) / (samples-1);
+    
+    GLKVector3 points[2*samples*samples];
+    GLKVector3 lower = GLKVector3Make(INFINITY, INFINITY, INFINITY);
+    GLKVector3 upper = GLKVector3Make(-INFINITY, -INFINITY, -INFINITY);
+    int count = 0;
+    
+    for( int sy = 0; sy < samples; sy++ ) {
+        for( int sx = 0; sx < samples; sx++ ) {
+            RAPolarCoordinate gpos;
+            gpos.latitude = lowerLeft.latitude + sy*latInterval;
+            gpos.longitude = lowerLeft.longitude + sx*lonInterval;
+            gpos.height = lowerLeft.height;
+            
+            // extrude the same way as the mesh
+            GLKVector3 ecef = ConvertPolarToEcef(gpos);
+            GLKVector3 normal = GLKVector3Normalize(ecef);
+            
+            points[count++] = GLKVector3Add( ecef, GLKVector3MultiplyScalar(normal, minHeight) );
+            points[count++] = GLKVector3Add( ecef, GLKVector3MultiplyScalar(normal, maxHeight) );
+        }
+    }
+    
+    for( int i = 0; i < count; i++ ) {
+        lower = GLKVector3Minimum(lower, points[i]);
+        upper = GLKVector3Maximum(upper, points[i]);
+    }
+    
+    GLKVector3 center = GLKVector3MultiplyScalar( GLKVector3Add(lower, upper), 0.5f );
+    float radius = 0.0f;
+    for( int i = 0; i < count; i++ ) {
+        radius = MAX( radius, GLKVector3Distance(center, points[i]) );
+    }
+    
+    // the surface bulges between samples, allow for the sagitta of the widest step
+    double step = GLKMathDegreesToRadians( MAX( fabs(latInterval), fabs(lonInterval) ) );
+    radius += ( kRadiusEquator + maxHeight ) * ( 1. - cos(0.5 * step) );
+    
+    return RABoundingSphereMake(center, radius);
+}
+
+- (float)heightMarginForTile:(TileID)t samples:(NSUInteger)samples {
+    RAPolarCoordinate lowerLeft = [self.imageryDatabase tileLatLonOrigin:t];
+    RAPolarCoordinate upperRight = [self.imageryDatabase tileLatLonOrigin:TileOppositeCorner(t)];
+    
+    // with slopes under 45 degrees, terrain at every finer level together rises less than two sample steps
+    double width = GLKMathDegreesToRadians( MAX( fabs(upperRight.latitude - lowerLeft.latitude), fabs(upperRight.longitude - lowerLeft.longitude) ) );
+    return MIN( 2. * kRadiusEquator * width / MAX( samples, 1 ), kTerrainScale );
+}
+
+- (RAPage *)makePageForTile:(TileID)t withParent:(RAPage *)parent {
     RAPage * page = [[RAPage alloc] initWithTileID:t andParent:parent];
     
-    // calculate tile center and radius
-    GLKVector3 center = ConvertPolarToEcef( [self.imageryDatabase tileLatLonCenter:page.tile] );
-    GLKVector3 corner = ConvertPolarToEcef( [self.imageryDatabase tileLatLonOrigin:page.tile] );
-    [page setCenter:center andRadius:GLKVector3Distance(center, corner)];
+    // a parent's range is padded to hold its descendants; the roots may be made before the
+    // terrain database is set, so they assume the highest terrain until real heights arrive
+    if ( parent ) {
+        page.minHeight = parent.minHeight;
+        page.maxHeight = parent.maxHeight;
+    } else {
+        page.minHeight = kSkirtDepth;
+        page.maxHeight = kTerrainScale;
+    }
+    page.bound = [self boundForTile:t minHeight:page.minHeight maxHeight:page.maxHeight];
+    
+    return page;
+}
+
+- (RAPage *)makeLeafPageForTile:(TileID)t withParent:(RAPage *)parent {
+    RAPage * page = [self makePageForTile:t withParent:parent];
     
     // any time we add new pages we should re-traverse to give them an oppurtunity to load
     _traverseAgain = YES;
@@ -475,12 +1541,100 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
     NSAssert( page != nil, @"the prepared page must be valid");
     
     // create child pages
-    if ( page.child1 == nil ) page.child1 = [self makeLeafPageForTile:(TileID){ 2*page.tile.x+0, 2*page.tile.y+0, page.tile.z+1 } withParent:page];
-    if ( page.child2 == nil ) page.child2 = [self makeLeafPageForTile:(TileID){ 2*page.tile.x+1, 2*page.tile.y+0, page.tile.z+1 } withParent:page];
-    if ( page.child3 == nil ) page.child3 = [self makeLeafPageForTile:(TileID){ 2*page.tile.x+0, 2*page.tile.y+1, page.tile.z+1 } withParent:page];
-    if ( page.child4 == nil ) page.child4 = [self makeLeafPageForTile:(TileID){ 2*page.tile.x+1, 2*page.tile.y+1, page.tile.z+1 } withParent:page];
+    @synchronized(_pageTreeLock) {
+        if ( page.child1 == nil ) page.child1 = [self makeLeafPageForTile:(TileID){ 2*page.tile.x+0, 2*page.tile.y+0, page.tile.z+1 } withParent:page];
+        if ( page.child2 == nil ) page.child2 = [self makeLeafPageForTile:(TileID){ 2*page.tile.x+1, 2*page.tile.y+0, page.tile.z+1 } withParent:page];
+        if ( page.child3 == nil ) page.child3 = [self makeLeafPageForTile:(TileID){ 2*page.tile.x+0, 2*page.tile.y+1, page.tile.z+1 } withParent:page];
+        if ( page.child4 == nil ) page.child4 = [self makeLeafPageForTile:(TileID){ 2*page.tile.x+1, 2*page.tile.y+1, page.tile.z+1 } withParent:page];
+    }
+}
+
+- (BOOL)page:(RAPage *)page needsDetailForView:(RAPagerView *)view {
+    // is the page onscreen?
+    if ( ! [page isOnscreenWithCamera:view.camera] ) return NO;
+    
+    return [self page:page exceedsErrorForView:view];
 }
 
+- (BOOL)page:(RAPage *)page exceedsErrorForView:(RAPagerView *)view {
+    RACamera * viewCamera = view.camera;
+    
+    // is the page facing the camera?
+    float cosTheta = [page calculateTiltWithCamera:viewCamera];
+    if ( cosTheta < -0.5f || ( page.tile.z > 2 && cosTheta < 0.0f ) ) return NO;
+    
+    // should we traverse to load more detail?
+    float texelError = [page calculateScreenSpaceErrorWithCamera:viewCamera];
+    return ( texelError > view.errorThreshold );
+}
+
+#if DEBUG
+
+// tiles a view would draw once loaded, walking bounds alone so the page count isn't disturbed;
+// resident pages use their own height range, the others inherit their parent's as they would be made
+- (NSUInteger)countTilesForView:(RAPagerView *)view tile:(TileID)t page:(RAPage *)page minHeight:(float)minHeight maxHeight:(float)maxHeight ellipsoidBounds:(BOOL)ellipsoid {
+    if ( page ) {
+        minHeight = page.minHeight;
+        maxHeight = page.maxHeight;
+    }
+    
+    RABoundingSphere bound;
+    if ( ellipsoid ) {
+        // the bound pages had before terrain heights were considered: tile center to corner, at sea level,
+        // culled with a 1.5x margin to allow for the terrain
+        GLKVector3 center = ConvertPolarToEcef( [self.imageryDatabase tileLatLonCenter:t] );
+        GLKVector3 corner = ConvertPolarToEcef( [self.imageryDatabase tileLatLonOrigin:t] );
+        bound = RABoundingSphereMake( center, GLKVector3Distance(center, corner) );
+        if ( ! [view.camera isBoundOnscreen:RABoundingSphereMake( bound.center, 1.5f * bound.radius )] ) return 0;
+    } else {
+        bound = page ? page.bound : [self boundForTile:t minHeight:minHeight maxHeight:maxHeight];
+        if ( ! [view.camera isBoundOnscreen:bound] ) return 0;
+    }
+    
+    float cosTheta = [RAPage tiltOfBound:bound withCamera:view.camera];
+    BOOL facing = ! ( cosTheta < -0.5f || ( t.z > 2 && cosTheta < 0.0f ) );
+    if ( t.z > self.imageryDatabase.maxzoom || ! facing || [RAPage screenSpaceErrorOfBound:bound withCamera:view.camera] <= view.errorThreshold ) return 1;
+    
+    RAPage * children[4] = { nil, nil, nil, nil };
+    if ( page && ! ellipsoid ) {
+        @synchronized(_pageTreeLock) {
+            children[0] = page.child1;
+            children[1] = page.child2;
+            children[2] = page.child3;
+            children[3] = page.child4;
+        }
+    }
+    
+    NSUInteger count = 0;
+    for( int i = 0; i < 4; i++ ) {
+        TileID child = { 2*t.x + (i & 1), 2*t.y + (i >> 1), t.z+1 };
+        count += [self countTilesForView:view tile:child page:children[i] minHeight:minHeight maxHeight:maxHeight ellipsoidBounds:ellipsoid];
+    }
+    return count;
+}
+
+- (void)logBoundComparison {
+    __block RATilePager * mySelf = self;
+    
+    [_updateQueue addOperationWithBlock:^{
+        RAPagerView * view = nil;
+        @synchronized(mySelf->_views) {
+            if ( mySelf->_views.count > 0 ) view = [mySelf->_views objectAtIndex:0];
+        }
+        if ( view.camera == nil ) return;
+        
+        NSUInteger tight = 0, ellipsoid = 0;
+        for( RAPage * root in mySelf->_rootPages ) {
+            tight += [mySelf countTilesForView:view tile:root.tile page:root minHeight:0 maxHeight:0 ellipsoidBounds:NO];
+            ellipsoid += [mySelf countTilesForView:view tile:root.tile page:nil minHeight:0 maxHeight:0 ellipsoidBounds:YES];
+        }
+        
+        NSLog(@"Bounds: %lu tiles with height-aware bounds, %lu with ellipsoid bounds", (unsigned long)tight, (unsigned long)ellipsoid);
+    }];
+}
+
+#endif
+
 - (void)traversePage:(RAPage *)page withTimestamp:(NSTimeInterval)timestamp {
     NSAssert( page != nil, @"the traversed page must be valid");
     
@@ -490,26 +1644,18 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
     // is the page below the maximum zoom level?
     if ( page.tile.z <= self.imageryDatabase.maxzoom )
     {
-        // is the page onscreen?
-        if ( [page isOnscreenWithCamera:self.camera] )
-        {
-            // is the page facing the camera?
-            float cosTheta = [page calculateTiltWithCamera:self.camera];
-            if ( !( cosTheta < -0.5f || ( page.tile.z > 2 && cosTheta < 0.0f )) )
+        // the children are loaded if any view wants more detail
+        for( RAPagerView * view in _traversalViews ) {
+            if ( [self page:page needsDetailForView:view] )
             {
-                // should we traverse to load more detail?
-                float texelError = [page calculateScreenSpaceErrorWithCamera:self.camera];
-                if ( texelError > 5.0f )
-                {
-                    // traverse children
-                    [self preparePageForTraversal:page];
-                    
-                    [self traversePage:page.child1 withTimestamp:timestamp];
-                    [self traversePage:page.child2 withTimestamp:timestamp];
-                    [self traversePage:page.child3 withTimestamp:timestamp];
-                    [self traversePage:page.child4 withTimestamp:timestamp];
-                    return;
-                }
+                // traverse children
+                [self preparePageForTraversal:page];
+                
+                [self traversePage:page.child1 withTimestamp:timestamp];
+                [self traversePage:page.child2 withTimestamp:timestamp];
+                [self traversePage:page.child3 withTimestamp:timestamp];
+                [self traversePage:page.child4 withTimestamp:timestamp];
+                return;
             }
         }
     }
@@ -518,7 +1664,9 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
     page.lastRequestedTimestamp = timestamp;
     
     // prune children
-    page.child1 = page.child2 = page.child3 = page.child4 = nil;
+    @synchronized(_pageTreeLock) {
+        page.child1 = page.child2 = page.child3 = page.child4 = nil;
+    }
 }
 
 - (void)requestUpdate {
@@ -544,6 +1692,11 @@ NSString * RATilePagerContentChangedNotification = @"RATilePagerContentChangedNo
 - (void)traverse {
     NSTimeInterval currentTime = [NSDate timeIntervalSinceReferenceDate];
     
+    // views added during the traversal are picked up by the next one
+    @synchronized(_views) {
+        _traversalViews = [_views copy];
+    }
+    
     do {
         _traverseAgain = NO;
         
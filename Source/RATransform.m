@@ -9,11 +9,29 @@
 #import "RATransform.h"
 
 #import "RABoundingSphere.h"
+#import "RACompiledGraph.h"
 
 
-@implementation RATransform
+@implementation RATransform {
+    GLKMatrix4  _transform;
+}
 
-@synthesize transform;
+- (GLKMatrix4)transform
+{
+    @synchronized(self) {
+        return _transform;
+    }
+}
+
+- (void)setTransform:(GLKMatrix4)transform
+{
+    @synchronized(self) {
+        _transform = transform;
+    }
+    
+    [self dirtyBound];
+    [_graph invalidateNode:self];
+}
 
 - (SEL)visitorSelector
 {
@@ -31,10 +49,14 @@
 
 - (void)calculateBound
 {
-    RABoundingSphere * newBound = [RABoundingSphere new];
-    [_children enumerateObjectsUsingBlock:^(RANode * child, NSUInteger idx, BOOL *stop) {
-        [newBound expandByBoundingSphere: [[child bound] transform: self.transform]];
-    }];
+    RABoundingSphere newBound = RABoundingSphereInvalid;
+    GLKMatrix4 transform = self.transform;
+    for( RANode * child in _children ) {
+        RABoundingSphere childBound = [child bound];
+        if ( RABoundingSphereIsValid(childBound) ) {
+            newBound = RABoundingSphereExpandBySphere( newBound, RABoundingSphereTransform( childBound, transform ) );
+        }
+    }
     _bound = newBound;
 }
 
@@ -0,0 +1,33 @@
+//
+//  RAUploadScheduler.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/4/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// higher values are uploaded first; evaluated each frame so it can follow the camera
+typedef float (^RAUploadPriorityBlock)(void);
+
+// spreads buffer and texture uploads over frames so a burst of tiles can't stall rendering
+@interface RAUploadScheduler : NSObject
+
+@property (assign) NSTimeInterval frameBudget;      // seconds of uploads per frame, default 4 ms
+@property (readonly) NSUInteger pendingCount;
+
+// stats for the most recent frame
+@property (readonly) NSUInteger lastFrameUploads;
+@property (readonly) NSUInteger lastFrameBytes;
+@property (readonly) NSTimeInterval lastFrameTime;
+@property (readonly) NSString * statsString;
+
+// may be called from any thread, bytes are only used for stats
+- (void)addUploadWithBytes:(NSUInteger)bytes priority:(RAUploadPriorityBlock)priority block:(void (^)(void))upload;
+- (void)cancelAllUploads;
+
+// call once per frame from within the rendering context; at least one upload always runs
+- (void)processUploads;
+
+@end
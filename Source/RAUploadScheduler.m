@@ -0,0 +1,118 @@
+//
+//  RAUploadScheduler.m
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/4/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#import "RAUploadScheduler.h"
+
+static const NSTimeInterval kDefaultFrameBudget = 0.004;
+
+
+@interface RAUploadTask : NSObject
+@property (assign) NSUInteger bytes;
+@property (assign) float priority;
+@property (copy) RAUploadPriorityBlock priorityBlock;
+@property (copy) void (^uploadBlock)(void);
+@end
+
+@implementation RAUploadTask
+@synthesize bytes, priority, priorityBlock, uploadBlock;
+@end
+
+
+@implementation RAUploadScheduler {
+    NSMutableArray *    _pending;
+}
+
+@synthesize frameBudget;
+@synthesize lastFrameUploads = _lastFrameUploads;
+@synthesize lastFrameBytes = _lastFrameBytes;
+@synthesize lastFrameTime = _lastFrameTime;
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        _pending = [NSMutableArray array];
+        self.frameBudget = kDefaultFrameBudget;
+    }
+    return self;
+}
+
+- (NSUInteger)pendingCount {
+    @synchronized(_pending) {
+        return [_pending count];
+    }
+}
+
+- (NSString *)statsString {
+    return [NSString stringWithFormat:@"%lu uploads (%lu KB) in %.1f ms, %lu queued",
+            (unsigned long)_lastFrameUploads, (unsigned long)( _lastFrameBytes / 1024 ), 1000. * _lastFrameTime, (unsigned long)self.pendingCount];
+}
+
+- (void)addUploadWithBytes:(NSUInteger)bytes priority:(RAUploadPriorityBlock)priority block:(void (^)(void))upload {
+    RAUploadTask * task = [RAUploadTask new];
+    task.bytes = bytes;
+    task.priorityBlock = priority;
+    task.uploadBlock = upload;
+
+    @synchronized(_pending) {
+        [_pending addObject:task];
+    }
+}
+
+- (void)cancelAllUploads {
+    @synchronized(_pending) {
+        [_pending removeAllObjects];
+    }
+}
+
+- (void)processUploads {
+    NSArray * tasks = nil;
+    @synchronized(_pending) {
+        tasks = [_pending copy];
+        [_pending removeAllObjects];
+    }
+
+    _lastFrameUploads = 0;
+    _lastFrameBytes = 0;
+    _lastFrameTime = 0;
+    if ( [tasks count] == 0 ) return;
+
+    // rank once per frame, the camera may have moved since the tasks were queued
+    for( RAUploadTask * task in tasks ) {
+        task.priority = task.priorityBlock ? task.priorityBlock() : 0.0f;
+    }
+    tasks = [tasks sortedArrayUsingComparator:^NSComparisonResult(RAUploadTask * a, RAUploadTask * b) {
+        if ( a.priority > b.priority ) return NSOrderedAscending;
+        if ( a.priority < b.priority ) return NSOrderedDescending;
+        return NSOrderedSame;
+    }];
+
+    NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
+    NSUInteger index = 0;
+
+    while( index < [tasks count] ) {
+        RAUploadTask * task = [tasks objectAtIndex:index++];
+        task.uploadBlock();
+
+        _lastFrameUploads++;
+        _lastFrameBytes += task.bytes;
+        _lastFrameTime = [NSDate timeIntervalSinceReferenceDate] - startTime;
+
+        if ( _lastFrameTime >= self.frameBudget ) break;
+    }
+
+    // leftovers wait for the next frame, ahead of anything queued meanwhile
+    if ( index < [tasks count] ) {
+        NSArray * remaining = [tasks subarrayWithRange:NSMakeRange(index, [tasks count] - index)];
+        @synchronized(_pending) {
+            [_pending replaceObjectsInRange:NSMakeRange(0, 0) withObjectsFromArray:remaining];
+        }
+    }
+}
+
+@end
@@ -7,7 +7,6 @@
 //
 
 #import "RAWorldTour.h"
-#import "TPPropertyAnimation.h"
 
 static const double kAnimationDuration = 5;
 
@@ -24,19 +23,8 @@ static const double kAnimationDuration = 5;
 - (void)start:(id)sender {
     timer = [NSTimer scheduledTimerWithTimeInterval:10 target:self selector:@selector(next:) userInfo:nil repeats:YES];
 
-    TPPropertyAnimation *anim1 = [TPPropertyAnimation propertyAnimationWithKeyPath:@"distance"];
-    anim1.duration = kAnimationDuration;
-    anim1.fromValue = [NSNumber numberWithDouble:manipulator.distance];
-    anim1.toValue = [NSNumber numberWithDouble:5e5];
-    anim1.timing = TPPropertyAnimationTimingEaseInEaseOut;
-    [anim1 beginWithTarget:self.manipulator];
-
-    TPPropertyAnimation *anim2 = [TPPropertyAnimation propertyAnimationWithKeyPath:@"elevation"];
-    anim2.duration = kAnimationDuration;
-    anim2.fromValue = [NSNumber numberWithDouble:manipulator.elevation];
-    anim2.toValue = [NSNumber numberWithDouble:80];
-    anim2.timing = TPPropertyAnimationTimingEaseInEaseOut;
-    [anim2 beginWithTarget:self.manipulator];
+    [self.manipulator animateField:RACameraDistance to:5e5 duration:kAnimationDuration timing:RAAnimationTimingEaseInEaseOut];
+    [self.manipulator animateField:RACameraElevation to:80 duration:kAnimationDuration timing:RAAnimationTimingEaseInEaseOut];
 
     [self next:sender];
 }
@@ -57,19 +45,8 @@ static const double kAnimationDuration = 5;
     double lat = -90 + ((double)rand() / RAND_MAX * 180.);
     double lon = -180 + ((double)rand() / RAND_MAX * 360.);
     
-    TPPropertyAnimation *anim1 = [TPPropertyAnimation propertyAnimationWithKeyPath:@"latitude"];
-    anim1.duration = kAnimationDuration;
-    anim1.fromValue = [NSNumber numberWithDouble:manipulator.latitude];
-    anim1.toValue = [NSNumber numberWithDouble:lat];
-    anim1.timing = TPPropertyAnimationTimingEaseInEaseOut;
-    [anim1 beginWithTarget:self.manipulator];
-    
-    TPPropertyAnimation *anim2 = [TPPropertyAnimation propertyAnimationWithKeyPath:@"longitude"];
-    anim2.duration = kAnimationDuration;
-    anim2.fromValue = [NSNumber numberWithDouble:manipulator.longitude];
-    anim2.toValue = [NSNumber numberWithDouble:lon];
-    anim2.timing = TPPropertyAnimationTimingEaseInEaseOut;
-    [anim2 beginWithTarget:self.manipulator];
+    [self.manipulator animateField:RACameraLatitude to:lat duration:kAnimationDuration timing:RAAnimationTimingEaseInEaseOut];
+    [self.manipulator animateField:RACameraLongitude to:lon duration:kAnimationDuration timing:RAAnimationTimingEaseInEaseOut];
 }
 
 @end
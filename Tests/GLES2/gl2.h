@@ -0,0 +1,27 @@
+//
+//  gl2.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/6/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+//  The few OpenGL ES 2 declarations the C sources use, so they build on hosts without
+//  the headers. The tests define the functions to record what would have been drawn.
+//
+
+#ifndef EarthViewExample_gl2_h
+#define EarthViewExample_gl2_h
+
+#include <stdint.h>
+
+typedef unsigned int    GLenum;
+typedef int             GLsizei;
+typedef unsigned short  GLushort;
+typedef void            GLvoid;
+
+#define GL_TRIANGLES        0x0004
+#define GL_UNSIGNED_SHORT   0x1403
+
+void glDrawElements( GLenum mode, GLsizei count, GLenum type, const GLvoid * indices );
+
+#endif
@@ -0,0 +1,178 @@
+//
+//  RABatchBuilderTests.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/6/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#include "RABatchBuilder.h"
+#include "TestMacros.h"
+
+#include <GLES2/gl2.h>
+#include <stdint.h>
+#include <string.h>
+
+#define kMaxRecords (64)
+#define kIndicesPerItem (6)
+
+// every call the batch draw makes, in order
+typedef struct {
+    enum { RecordPrepare, RecordDraw } kind;
+    uint32_t    page;           // prepare
+    uint32_t    texture;
+    GLenum      mode;           // draw
+    GLsizei     count;
+    size_t      offset;
+} Record;
+
+static Record sRecords[kMaxRecords];
+static int sRecordCount = 0;
+
+void glDrawElements( GLenum mode, GLsizei count, GLenum type, const GLvoid * indices )
+{
+    CHECK( type == GL_UNSIGNED_SHORT );
+    if ( sRecordCount == kMaxRecords ) return;
+
+    Record * r = &sRecords[sRecordCount++];
+    r->kind = RecordDraw;
+    r->mode = mode;
+    r->count = count;
+    r->offset = (size_t)indices;
+}
+
+static void RecordBatch( const RABatch * batch, void * context )
+{
+    (*(int *)context)++;
+    if ( sRecordCount == kMaxRecords ) return;
+
+    Record * r = &sRecords[sRecordCount++];
+    r->kind = RecordPrepare;
+    r->page = batch->page;
+    r->texture = batch->textures[0];
+}
+
+static RABatchItem MakeItem( uint32_t transform, uint32_t texture0, uint32_t texture1, uint32_t page, uint32_t slot )
+{
+    RABatchItem item;
+    memset( &item, 0, sizeof(item) );
+    item.transform = transform;
+    item.textures[0] = texture0;
+    item.textures[1] = texture1;
+    item.page = page;
+    item.slot = slot;
+    return item;
+}
+
+static void TestEmpty( void )
+{
+    RABatch batches[1];
+    CHECK( RABatchBuild( NULL, 0, batches ) == 0 );
+
+    sRecordCount = 0;
+    CHECK( RABatchDraw( batches, 0, kIndicesPerItem, GL_TRIANGLES, RecordBatch, &(int){0} ) == 0 );
+    CHECK( sRecordCount == 0 );
+}
+
+static void TestGrouping( void )
+{
+    // two atlas textures over two vertex pages, in the back to front order the renderer queues them
+    RABatchItem items[] = {
+        MakeItem( 0, 7, 0, 1, 4 ),
+        MakeItem( 0, 5, 0, 0, 9 ),
+        MakeItem( 0, 7, 0, 1, 2 ),
+        MakeItem( 0, 5, 0, 0, 1 ),
+        MakeItem( 0, 7, 0, 0, 3 ),
+        MakeItem( 0, 5, 0, 0, 6 ),
+    };
+    const size_t count = sizeof(items) / sizeof(items[0]);
+    RABatch batches[sizeof(items) / sizeof(items[0])];
+
+    size_t batchCount = RABatchBuild( items, count, batches );
+    CHECK( batchCount == 3 );
+
+    // sorted by key, then by slot within each batch
+    CHECK( batches[0].textures[0] == 5 && batches[0].page == 0 && batches[0].firstItem == 0 && batches[0].itemCount == 3 );
+    CHECK( batches[1].textures[0] == 7 && batches[1].page == 0 && batches[1].firstItem == 3 && batches[1].itemCount == 1 );
+    CHECK( batches[2].textures[0] == 7 && batches[2].page == 1 && batches[2].firstItem == 4 && batches[2].itemCount == 2 );
+    CHECK( items[0].slot == 1 && items[1].slot == 6 && items[2].slot == 9 );
+    CHECK( items[4].slot == 2 && items[5].slot == 4 );
+}
+
+static void TestSplitsOnEveryKey( void )
+{
+    // items differing only by transform, overlay texture or page never share a draw
+    RABatchItem items[] = {
+        MakeItem( 0, 5, 0, 0, 0 ),
+        MakeItem( 1, 5, 0, 0, 1 ),
+        MakeItem( 0, 5, 8, 0, 2 ),
+        MakeItem( 0, 5, 0, 1, 3 ),
+        MakeItem( 0, 5, 0, 0, 4 ),
+    };
+    const size_t count = sizeof(items) / sizeof(items[0]);
+    RABatch batches[sizeof(items) / sizeof(items[0])];
+
+    CHECK( RABatchBuild( items, count, batches ) == 4 );
+    CHECK( batches[0].itemCount == 2 );
+}
+
+static void TestDrawCalls( void )
+{
+    RABatchItem items[] = {
+        MakeItem( 0, 7, 0, 1, 4 ),
+        MakeItem( 0, 5, 0, 0, 9 ),
+        MakeItem( 0, 7, 0, 1, 2 ),
+        MakeItem( 0, 5, 0, 0, 1 ),
+        MakeItem( 0, 7, 0, 0, 3 ),
+    };
+    const size_t count = sizeof(items) / sizeof(items[0]);
+    RABatch batches[sizeof(items) / sizeof(items[0])];
+    size_t batchCount = RABatchBuild( items, count, batches );
+
+    sRecordCount = 0;
+    int prepared = 0;
+    CHECK( RABatchDraw( batches, batchCount, kIndicesPerItem, GL_TRIANGLES, RecordBatch, &prepared ) == 3 );
+    CHECK( prepared == 3 );
+    CHECK( sRecordCount == 6 );
+
+    // each batch is prepared and then drawn once, over its own run of the index stream
+    size_t nextOffset = 0;
+    for( int b = 0; b < 3 && 2*b+1 < sRecordCount; b++ ) {
+        const Record * prepare = &sRecords[2*b];
+        const Record * draw = &sRecords[2*b+1];
+
+        CHECK( prepare->kind == RecordPrepare );
+        CHECK( prepare->page == batches[b].page && prepare->texture == batches[b].textures[0] );
+
+        CHECK( draw->kind == RecordDraw );
+        CHECK( draw->mode == GL_TRIANGLES );
+        CHECK( draw->count == (GLsizei)( batches[b].itemCount * kIndicesPerItem ) );
+        CHECK( draw->offset == nextOffset );
+        nextOffset += batches[b].itemCount * kIndicesPerItem * sizeof(GLushort);
+    }
+
+    // together the draws cover every item exactly once
+    CHECK( nextOffset == count * kIndicesPerItem * sizeof(GLushort) );
+}
+
+static void TestDrawWithoutPrepare( void )
+{
+    RABatchItem items[] = { MakeItem( 0, 5, 0, 0, 0 ), MakeItem( 0, 5, 0, 0, 1 ) };
+    RABatch batches[2];
+    size_t batchCount = RABatchBuild( items, 2, batches );
+
+    sRecordCount = 0;
+    CHECK( RABatchDraw( batches, batchCount, kIndicesPerItem, GL_TRIANGLES, NULL, NULL ) == 1 );
+    CHECK( sRecordCount == 1 && sRecords[0].kind == RecordDraw && sRecords[0].count == 2 * kIndicesPerItem );
+}
+
+int main( void )
+{
+    RUN_TEST( TestEmpty );
+    RUN_TEST( TestGrouping );
+    RUN_TEST( TestSplitsOnEveryKey );
+    RUN_TEST( TestDrawCalls );
+    RUN_TEST( TestDrawWithoutPrepare );
+
+    return ( sTestFailures == 0 ) ? 0 : 1;
+}
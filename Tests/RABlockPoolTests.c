@@ -0,0 +1,149 @@
+//
+//  RABlockPoolTests.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/5/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#include "RABlockPool.h"
+#include "TestMacros.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// tile meshes as the pager builds them: a 32x32 grid plus a border, with 6 floats and
+// 2 per imagery layer for each vertex, and 6 indices per cell
+#define kTotalSize      (34)
+#define kResidentMeshes (64)
+#define kMeshes         (1024)
+
+typedef struct {
+    void *  vertices;
+    size_t  vertexLength;
+    void *  indices;
+    size_t  indexLength;
+} Mesh;
+
+static size_t VertexLength( int layers ) { return ( 6 + 2 * layers ) * sizeof(float) * kTotalSize * kTotalSize; }
+static size_t IndexLength( void ) { return 6 * sizeof(unsigned short) * ( kTotalSize - 1 ) * ( kTotalSize - 1 ); }
+
+static void ReleaseMesh( RABlockPool * pool, Mesh * mesh )
+{
+    RABlockPoolRelease( pool, mesh->vertices, mesh->vertexLength );
+    RABlockPoolRelease( pool, mesh->indices, mesh->indexLength );
+    memset( mesh, 0, sizeof(Mesh) );
+}
+
+// rebuilds meshes in a ring of resident tiles, each replacing the oldest, with the layer
+// count changing as overlays come and go; copying meshes go through RABlockPoolCopy
+static void BuildMeshes( RABlockPool * pool, Mesh * resident, int first, int count, bool copying )
+{
+    static float sVertexData[( 6 + 2 * 3 ) * kTotalSize * kTotalSize];
+    static unsigned short sIndexData[6 * ( kTotalSize - 1 ) * ( kTotalSize - 1 )];
+
+    for( int i = first; i < first + count; i++ ) {
+        Mesh * mesh = &resident[i % kResidentMeshes];
+        ReleaseMesh( pool, mesh );
+
+        mesh->vertexLength = VertexLength( 1 + i % 3 );
+        mesh->indexLength = IndexLength();
+        if ( copying ) {
+            mesh->vertices = RABlockPoolCopy( pool, sVertexData, mesh->vertexLength );
+            mesh->indices = RABlockPoolCopy( pool, sIndexData, mesh->indexLength );
+        } else {
+            mesh->vertices = RABlockPoolAcquire( pool, mesh->vertexLength );
+            mesh->indices = RABlockPoolAcquire( pool, mesh->indexLength );
+            memset( mesh->vertices, 0, mesh->vertexLength );
+            memset( mesh->indices, 0, mesh->indexLength );
+        }
+    }
+}
+
+static void TestCostPerMesh( void )
+{
+    RABlockPool pool;
+    RABlockPoolInit( &pool, 16*1024*1024 );
+    Mesh resident[kResidentMeshes];
+    memset( resident, 0, sizeof(resident) );
+
+    // warm up until each size class holds as many blocks as the resident meshes need, then
+    // measure the steady state
+    BuildMeshes( &pool, resident, 0, kMeshes, false );
+    size_t allocations = pool.allocationCount, copied = pool.bytesCopied;
+    BuildMeshes( &pool, resident, kMeshes, kMeshes, false );
+    float allocationsPerMesh = (float)( pool.allocationCount - allocations ) / kMeshes;
+    float copiedPerMesh = (float)( pool.bytesCopied - copied ) / kMeshes;
+    printf( "  filled in place: %.2f allocs/mesh, %.0f B copied/mesh\n", allocationsPerMesh, copiedPerMesh );
+    CHECK( allocationsPerMesh == 0.0f );
+    CHECK( copiedPerMesh == 0.0f );
+
+    // the copying setters still reuse blocks, but pay for the copy
+    allocations = pool.allocationCount;
+    copied = pool.bytesCopied;
+    BuildMeshes( &pool, resident, 2 * kMeshes, kMeshes, true );
+    allocationsPerMesh = (float)( pool.allocationCount - allocations ) / kMeshes;
+    copiedPerMesh = (float)( pool.bytesCopied - copied ) / kMeshes;
+    printf( "  copied:          %.2f allocs/mesh, %.0f B copied/mesh\n", allocationsPerMesh, copiedPerMesh );
+    CHECK( allocationsPerMesh == 0.0f );
+    size_t expected = 0;
+    for( int i = 2 * kMeshes; i < 3 * kMeshes; i++ ) expected += VertexLength( 1 + i % 3 ) + IndexLength();
+    CHECK( pool.bytesCopied - copied == expected );
+
+    for( int i = 0; i < kResidentMeshes; i++ ) ReleaseMesh( &pool, &resident[i] );
+    RABlockPoolDestroy( &pool );
+}
+
+static void TestSizeClasses( void )
+{
+    // a block is never smaller than asked for, and wastes at most a fifth of itself
+    for( size_t length = 1; length < 4*1024*1024; length = length * 5 / 4 + 1 ) {
+        size_t size = RABlockPoolBlockSize( length );
+        CHECK( size >= length );
+        if ( length >= 1024 && length <= 3584*1024 ) CHECK( size - length <= size / 5 );
+    }
+
+    // lengths in the same class share blocks
+    RABlockPool pool;
+    RABlockPoolInit( &pool, 1024*1024 );
+    void * block = RABlockPoolAcquire( &pool, 5000 );
+    RABlockPoolRelease( &pool, block, 5000 );
+    CHECK( pool.retainedBytes == RABlockPoolBlockSize(5000) );
+    CHECK( RABlockPoolAcquire( &pool, 4900 ) == block );
+    CHECK( pool.reuseCount == 1 && pool.allocationCount == 1 && pool.retainedBytes == 0 );
+    RABlockPoolRelease( &pool, block, 4900 );
+    RABlockPoolDestroy( &pool );
+}
+
+static void TestRetainLimit( void )
+{
+    RABlockPool pool;
+    RABlockPoolInit( &pool, 3 * 1024 );
+
+    // only as many free blocks as fit under the limit are kept, the rest are freed
+    void * blocks[5];
+    for( int i = 0; i < 5; i++ ) blocks[i] = RABlockPoolAcquire( &pool, 1024 );
+    for( int i = 0; i < 5; i++ ) RABlockPoolRelease( &pool, blocks[i], 1024 );
+    CHECK( pool.retainedBytes == 3 * 1024 );
+
+    // blocks too big for any class are never kept
+    pool.maxRetainedBytes = 64*1024*1024;
+    void * big = RABlockPoolAcquire( &pool, 8*1024*1024 );
+    RABlockPoolRelease( &pool, big, 8*1024*1024 );
+    CHECK( pool.retainedBytes == 3 * 1024 );
+
+    RABlockPoolPurge( &pool );
+    CHECK( pool.retainedBytes == 0 );
+    void * fresh = RABlockPoolAcquire( &pool, 1024 );
+    CHECK( pool.allocationCount == 7 && pool.reuseCount == 0 );
+    RABlockPoolRelease( &pool, fresh, 1024 );
+    RABlockPoolDestroy( &pool );
+}
+
+int main( void )
+{
+    RUN_TEST( TestCostPerMesh );
+    RUN_TEST( TestSizeClasses );
+    RUN_TEST( TestRetainLimit );
+    return ( sTestFailures == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+//
+//  RASlotAllocatorTests.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/6/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#include "RASlotAllocator.h"
+#include "TestMacros.h"
+
+static void TestAcquireInOrder( void )
+{
+    RASlotAllocator allocator;
+    CHECK( RASlotAllocatorInit( &allocator, 40 ) );
+
+    // slots come out lowest first, across the word boundary
+    for( int i = 0; i < 40; i++ ) CHECK( RASlotAllocatorAcquire( &allocator ) == i );
+    CHECK( allocator.count == 40 );
+
+    RASlotAllocatorDestroy( &allocator );
+    CHECK( allocator.bits == NULL && allocator.capacity == 0 && allocator.count == 0 );
+}
+
+static void TestReleaseReusesLowest( void )
+{
+    RASlotAllocator allocator;
+    CHECK( RASlotAllocatorInit( &allocator, 70 ) );
+    for( int i = 0; i < 70; i++ ) RASlotAllocatorAcquire( &allocator );
+
+    // freed slots are handed out again lowest first, so live slots stay packed at the front
+    RASlotAllocatorRelease( &allocator, 65 );
+    RASlotAllocatorRelease( &allocator, 33 );
+    RASlotAllocatorRelease( &allocator, 3 );
+    CHECK( allocator.count == 67 );
+
+    CHECK( RASlotAllocatorAcquire( &allocator ) == 3 );
+    CHECK( RASlotAllocatorAcquire( &allocator ) == 33 );
+    CHECK( RASlotAllocatorAcquire( &allocator ) == 65 );
+    CHECK( allocator.count == 70 );
+
+    RASlotAllocatorDestroy( &allocator );
+}
+
+static void TestReleaseAllCoalesces( void )
+{
+    RASlotAllocator allocator;
+    CHECK( RASlotAllocatorInit( &allocator, 64 ) );
+    for( int i = 0; i < 64; i++ ) RASlotAllocatorAcquire( &allocator );
+
+    // release in a scattered order; afterwards the page is as good as new
+    for( int i = 0; i < 64; i++ ) RASlotAllocatorRelease( &allocator, ( i * 37 ) % 64 );
+    CHECK( allocator.count == 0 );
+    CHECK( allocator.bits[0] == 0 && allocator.bits[1] == 0 );
+
+    for( int i = 0; i < 64; i++ ) CHECK( RASlotAllocatorAcquire( &allocator ) == i );
+
+    RASlotAllocatorDestroy( &allocator );
+}
+
+static void TestFull( void )
+{
+    RASlotAllocator allocator;
+    CHECK( RASlotAllocatorInit( &allocator, 5 ) );
+
+    for( int i = 0; i < 5; i++ ) CHECK( ! RASlotAllocatorIsFull( &allocator ) && RASlotAllocatorAcquire( &allocator ) == i );
+
+    // the bits past the capacity in the last word are never handed out
+    CHECK( RASlotAllocatorIsFull( &allocator ) );
+    CHECK( RASlotAllocatorAcquire( &allocator ) == -1 );
+    CHECK( allocator.count == 5 );
+
+    RASlotAllocatorRelease( &allocator, 2 );
+    CHECK( ! RASlotAllocatorIsFull( &allocator ) );
+    CHECK( RASlotAllocatorAcquire( &allocator ) == 2 );
+    CHECK( RASlotAllocatorAcquire( &allocator ) == -1 );
+
+    RASlotAllocatorDestroy( &allocator );
+}
+
+static void TestEmpty( void )
+{
+    RASlotAllocator allocator;
+    RASlotAllocatorInit( &allocator, 0 );
+
+    CHECK( RASlotAllocatorIsFull( &allocator ) );
+    CHECK( RASlotAllocatorAcquire( &allocator ) == -1 );
+
+    RASlotAllocatorDestroy( &allocator );
+}
+
+int main( void )
+{
+    RUN_TEST( TestAcquireInOrder );
+    RUN_TEST( TestReleaseReusesLowest );
+    RUN_TEST( TestReleaseAllCoalesces );
+    RUN_TEST( TestFull );
+    RUN_TEST( TestEmpty );
+
+    return ( sTestFailures == 0 ) ? 0 : 1;
+}
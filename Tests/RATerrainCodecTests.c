@@ -0,0 +1,235 @@
+//
+//  RATerrainCodecTests.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/8/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#include "RATerrainCodec.h"
+#include "TestMacros.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int kFlagCombinations[] = {
+    0,
+    RATerrainFlagDelta,
+    RATerrainFlagDeflate,
+    RATerrainFlagDelta | RATerrainFlagDeflate
+};
+
+// from a single byte at a time up to more than a raw 256x256 tile holds
+static const size_t kFeedSizes[] = { 1, 2, 3, 7, 19, 20, 21, 512, 4095, 65536, 88 * 1024 };
+
+static void MakeTerrain( RAHeightMap * map, int width, int height )
+{
+    RAHeightMapInit( map, width, height );
+    for( int y = 0; y < height; y++ ) {
+        for( int x = 0; x < width; x++ ) {
+            map->heights[y * width + x] = 1000.0f * sinf( x * 0.05f ) * cosf( y * 0.03f ) + 500.0f + ( ( x * 7 + y * 13 ) % 11 );
+        }
+    }
+    RAHeightMapUpdateRange( map );
+}
+
+static RATerrainDecodeStatus DecodeInPieces( const uint8_t * bytes, size_t length, size_t feedSize, RAHeightMap * out )
+{
+    RATerrainDecoder decoder;
+    RATerrainDecoderInit( &decoder );
+
+    RATerrainDecodeStatus status = RATerrainDecodeNeedsData;
+    for( size_t pos = 0; pos < length && status == RATerrainDecodeNeedsData; pos += feedSize ) {
+        size_t n = ( feedSize < length - pos ) ? feedSize : length - pos;
+        status = RATerrainDecoderFeed( &decoder, bytes + pos, n );
+    }
+
+    if ( status == RATerrainDecodeDone ) CHECK( RATerrainDecoderTakeMap( &decoder, out ) );
+    RATerrainDecoderDestroy( &decoder );
+    return status;
+}
+
+static void CheckRoundTrip( const RAHeightMap * map, uint8_t flags, size_t feedSize )
+{
+    uint8_t * bytes = NULL;
+    size_t length = 0;
+    CHECK( RATerrainEncode( map, flags, &bytes, &length ) );
+    if ( bytes == NULL ) return;
+
+    RATerrainHeader header;
+    CHECK( RATerrainReadHeader( bytes, length, &header ) );
+    CHECK( header.flags == flags && header.width == map->width && header.height == map->height );
+
+    RAHeightMap out;
+    memset( &out, 0, sizeof(out) );
+    CHECK( DecodeInPieces( bytes, length, feedSize, &out ) == RATerrainDecodeDone );
+
+    if ( out.heights ) {
+        CHECK( out.width == map->width && out.height == map->height );
+        CHECK( out.minHeight == map->minHeight && out.maxHeight == map->maxHeight );
+
+        // within half a quantization step, with a little room for float rounding
+        float tolerance = 0.5f * ( map->maxHeight - map->minHeight ) / 65535.0f + 1e-3f;
+        float maxError = 0.0f;
+        for( int i = 0; i < map->width * map->height; i++ ) maxError = fmaxf( maxError, fabsf( out.heights[i] - map->heights[i] ) );
+        CHECK( maxError <= tolerance );
+        if ( maxError > tolerance ) fprintf( stderr, "  flags %d, feeds of %zu bytes: error %f m\n", flags, feedSize, maxError );
+    }
+
+    RAHeightMapDestroy( &out );
+    free( bytes );
+}
+
+static void TestRoundTrip( void )
+{
+    RAHeightMap map;
+    MakeTerrain( &map, 256, 256 );
+
+    for( size_t f = 0; f < sizeof(kFlagCombinations) / sizeof(kFlagCombinations[0]); f++ ) {
+        for( size_t s = 0; s < sizeof(kFeedSizes) / sizeof(kFeedSizes[0]); s++ ) {
+            CheckRoundTrip( &map, kFlagCombinations[f], kFeedSizes[s] );
+        }
+    }
+
+    RAHeightMapDestroy( &map );
+}
+
+static void TestOddSizes( void )
+{
+    // odd widths put a sample across every other feed boundary
+    RAHeightMap map;
+    MakeTerrain( &map, 33, 17 );
+
+    for( size_t f = 0; f < sizeof(kFlagCombinations) / sizeof(kFlagCombinations[0]); f++ ) {
+        CheckRoundTrip( &map, kFlagCombinations[f], 1 );
+        CheckRoundTrip( &map, kFlagCombinations[f], 5 );
+    }
+
+    RAHeightMapDestroy( &map );
+}
+
+static void TestFlat( void )
+{
+    RAHeightMap map;
+    RAHeightMapInit( &map, 4, 4 );
+    for( int i = 0; i < 16; i++ ) map.heights[i] = 42.0f;
+    RAHeightMapUpdateRange( &map );
+
+    for( size_t f = 0; f < sizeof(kFlagCombinations) / sizeof(kFlagCombinations[0]); f++ ) {
+        CheckRoundTrip( &map, kFlagCombinations[f], 3 );
+    }
+
+    RAHeightMapDestroy( &map );
+}
+
+static void TestRejectsBadHeaders( void )
+{
+    RAHeightMap map;
+    MakeTerrain( &map, 8, 8 );
+
+    uint8_t * good = NULL;
+    size_t length = 0;
+    CHECK( RATerrainEncode( &map, 0, &good, &length ) );
+    RAHeightMapDestroy( &map );
+    if ( good == NULL ) return;
+
+    uint8_t * bytes = (uint8_t *)malloc( length );
+    RATerrainHeader header;
+    RAHeightMap out;
+
+    // magic, version, unknown flags, too narrow, too short, and a NaN range
+    const struct { size_t offset; size_t length; uint8_t value[4]; } corruptions[] = {
+        { 0, 1, { 'X' } },
+        { 4, 1, { kRATerrainVersion + 1 } },
+        { 5, 1, { 0x80 } },
+        { 6, 2, { 1, 0 } },
+        { 8, 2, { 1, 0 } },
+        { 12, 4, { 0xFF, 0xFF, 0xFF, 0xFF } }
+    };
+    for( size_t c = 0; c < sizeof(corruptions) / sizeof(corruptions[0]); c++ ) {
+        memcpy( bytes, good, length );
+        memcpy( bytes + corruptions[c].offset, corruptions[c].value, corruptions[c].length );
+
+        CHECK( ! RATerrainReadHeader( bytes, length, &header ) );
+        CHECK( DecodeInPieces( bytes, length, 7, &out ) == RATerrainDecodeError );
+    }
+
+    // too short to hold a header at all
+    CHECK( ! RATerrainReadHeader( good, kRATerrainHeaderSize - 1, &header ) );
+
+    free( bytes );
+    free( good );
+}
+
+static void TestTruncated( void )
+{
+    RAHeightMap map;
+    MakeTerrain( &map, 64, 64 );
+
+    for( size_t f = 0; f < sizeof(kFlagCombinations) / sizeof(kFlagCombinations[0]); f++ ) {
+        uint8_t * bytes = NULL;
+        size_t length = 0;
+        CHECK( RATerrainEncode( &map, kFlagCombinations[f], &bytes, &length ) );
+        if ( bytes == NULL ) continue;
+
+        // a tile cut short keeps waiting for the rest; a deflated tile is done once its
+        // samples are in, before the zlib trailer, so cut that one well inside the samples
+        RAHeightMap out;
+        size_t cut = ( kFlagCombinations[f] & RATerrainFlagDeflate ) ? length / 2 : length - 1;
+        CHECK( DecodeInPieces( bytes, cut, 100, &out ) == RATerrainDecodeNeedsData );
+        CHECK( DecodeInPieces( bytes, kRATerrainHeaderSize / 2, 1, &out ) == RATerrainDecodeNeedsData );
+        free( bytes );
+    }
+
+    RAHeightMapDestroy( &map );
+}
+
+static void TestCorruptStream( void )
+{
+    RAHeightMap map;
+    MakeTerrain( &map, 64, 64 );
+
+    uint8_t * bytes = NULL;
+    size_t length = 0;
+    CHECK( RATerrainEncode( &map, RATerrainFlagDeflate, &bytes, &length ) );
+    RAHeightMapDestroy( &map );
+    if ( bytes == NULL ) return;
+
+    // a broken zlib header is an error rather than a hang or an overrun
+    bytes[kRATerrainHeaderSize] ^= 0xFF;
+    RAHeightMap out;
+    CHECK( DecodeInPieces( bytes, length, 64, &out ) == RATerrainDecodeError );
+
+    free( bytes );
+}
+
+static void TestSample( void )
+{
+    RAHeightMap map;
+    RAHeightMapInit( &map, 2, 2 );
+    map.heights[0] = 0.0f;  map.heights[1] = 10.0f;
+    map.heights[2] = 20.0f; map.heights[3] = 30.0f;
+
+    CHECK( RAHeightMapSample( &map, 0.0f, 0.0f ) == 0.0f );
+    CHECK( RAHeightMapSample( &map, 1.0f, 1.0f ) == 30.0f );
+    CHECK( fabsf( RAHeightMapSample( &map, 0.5f, 0.5f ) - 15.0f ) < 1e-5f );
+
+    // clamped to the grid
+    CHECK( RAHeightMapSample( &map, -1.0f, 2.0f ) == 20.0f );
+
+    RAHeightMapDestroy( &map );
+}
+
+int main( void )
+{
+    RUN_TEST( TestRoundTrip );
+    RUN_TEST( TestOddSizes );
+    RUN_TEST( TestFlat );
+    RUN_TEST( TestRejectsBadHeaders );
+    RUN_TEST( TestTruncated );
+    RUN_TEST( TestCorruptStream );
+    RUN_TEST( TestSample );
+
+    return ( sTestFailures == 0 ) ? 0 : 1;
+}
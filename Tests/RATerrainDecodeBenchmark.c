@@ -0,0 +1,87 @@
+//
+//  RATerrainDecodeBenchmark.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/8/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "RATerrainCodec.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// decodes a 256x256 tile the way a connection delivers it, in 4 KB pieces
+#define kTileSize       (256)
+#define kChunkSize      (4096)
+#define kIterations     (200)
+
+static double Now( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool Decode( const uint8_t * bytes, size_t length )
+{
+    RATerrainDecoder decoder;
+    RATerrainDecoderInit( &decoder );
+
+    RATerrainDecodeStatus status = RATerrainDecodeNeedsData;
+    for( size_t pos = 0; pos < length && status == RATerrainDecodeNeedsData; pos += kChunkSize ) {
+        size_t n = ( kChunkSize < length - pos ) ? kChunkSize : length - pos;
+        status = RATerrainDecoderFeed( &decoder, bytes + pos, n );
+    }
+
+    RAHeightMap map;
+    bool ok = ( status == RATerrainDecodeDone ) && RATerrainDecoderTakeMap( &decoder, &map );
+    if ( ok ) RAHeightMapDestroy( &map );
+    RATerrainDecoderDestroy( &decoder );
+    return ok;
+}
+
+int main( void )
+{
+    RAHeightMap map;
+    RAHeightMapInit( &map, kTileSize, kTileSize );
+    for( int y = 0; y < kTileSize; y++ ) {
+        for( int x = 0; x < kTileSize; x++ ) {
+            map.heights[y * kTileSize + x] = 1000.0f * sinf( x * 0.05f ) * cosf( y * 0.03f ) + 500.0f;
+        }
+    }
+    RAHeightMapUpdateRange( &map );
+
+    const struct { uint8_t flags; const char * name; } modes[] = {
+        { 0, "raw" },
+        { RATerrainFlagDelta, "delta" },
+        { RATerrainFlagDeflate, "deflate" },
+        { RATerrainFlagDelta | RATerrainFlagDeflate, "delta+deflate" }
+    };
+
+    printf( "%dx%d tile, %d byte feeds, %d iterations\n", kTileSize, kTileSize, kChunkSize, kIterations );
+    for( size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++ ) {
+        uint8_t * bytes = NULL;
+        size_t length = 0;
+        if ( ! RATerrainEncode( &map, modes[m].flags, &bytes, &length ) ) return 1;
+
+        if ( ! Decode( bytes, length ) ) {
+            fprintf( stderr, "%s: decode failed\n", modes[m].name );
+            return 1;
+        }
+
+        double start = Now();
+        for( int i = 0; i < kIterations; i++ ) Decode( bytes, length );
+        double elapsed = Now() - start;
+
+        printf( "  %-14s %7zu bytes  %8.1f us per tile\n", modes[m].name, length, elapsed / kIterations * 1e6 );
+        free( bytes );
+    }
+
+    RAHeightMapDestroy( &map );
+    return 0;
+}
@@ -0,0 +1,64 @@
+//
+//  RATerrainPickBenchmark.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/3/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "RATerrainTree.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// picks against a 33x33 tile grid, the size of a tile mesh, from a camera above and to one side
+#define kGridSize       (33)
+#define kQueries        (1000000)
+
+static double Now( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main( void )
+{
+    float * vertices = (float *)malloc( 3 * kGridSize * kGridSize * sizeof(float) );
+    for( int y = 0; y < kGridSize; y++ ) {
+        for( int x = 0; x < kGridSize; x++ ) {
+            float * v = &vertices[3 * ( y * kGridSize + x )];
+            v[0] = x; v[1] = y; v[2] = 4.0f * sinf( x * 0.4f ) * cosf( y * 0.3f );
+        }
+    }
+
+    RATerrainTree tree;
+    double start = Now();
+    if ( ! RATerrainTreeInit( &tree, vertices, kGridSize, kGridSize, 3, 3 * kGridSize ) ) return 1;
+    double built = Now() - start;
+
+    // aim at a spread of points across the tile; srand keeps runs comparable
+    srand( 1 );
+    float eye[3] = { -10.0f, -10.0f, 30.0f };
+    int hits = 0;
+    start = Now();
+    for( int i = 0; i < kQueries; i++ ) {
+        float tx = (float)rand() / RAND_MAX * ( kGridSize - 1 );
+        float ty = (float)rand() / RAND_MAX * ( kGridSize - 1 );
+        float end[3] = { eye[0] + 2.0f * ( tx - eye[0] ), eye[1] + 2.0f * ( ty - eye[1] ), eye[2] - 2.0f * eye[2] };
+        float fraction = 1.0f;
+        if ( RATerrainTreeIntersect( &tree, eye, end, &fraction, 0, 0, kGridSize - 1, kGridSize - 1 ) ) hits++;
+    }
+    double elapsed = Now() - start;
+
+    printf( "%dx%d grid, %d nodes, built in %.1f us\n", kGridSize, kGridSize, tree.nodeCount, built * 1e6 );
+    printf( "  %d queries, %d hits, %.0f queries per second\n", kQueries, hits, kQueries / elapsed );
+
+    RATerrainTreeDestroy( &tree );
+    free( vertices );
+    return 0;
+}
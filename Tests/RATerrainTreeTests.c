@@ -0,0 +1,136 @@
+//
+//  RATerrainTreeTests.c
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/3/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#include "RATerrainTree.h"
+#include "TestMacros.h"
+
+#include <math.h>
+
+#define kSize       (17)
+#define kStride     (5)     // position plus texture coordinates, as in the tile meshes
+
+// a grid in the x-y plane with unit cells, z from the given function, padded like a vertex buffer
+static float sVertices[kSize * kSize * kStride];
+
+static void FillGrid( float (*heightAt)( int x, int y ) )
+{
+    for( int y = 0; y < kSize; y++ ) {
+        for( int x = 0; x < kSize; x++ ) {
+            float * v = &sVertices[( y * kSize + x ) * kStride];
+            v[0] = x; v[1] = y; v[2] = heightAt( x, y );
+            v[3] = v[4] = -1.0f;
+        }
+    }
+}
+
+static float Flat( int x, int y ) { (void)x; (void)y; return 0.0f; }
+static float Below( int x, int y ) { (void)x; (void)y; return -100.0f; }
+static float Ridge( int x, int y ) { (void)y; return ( x == 8 ) ? 10.0f : 0.0f; }
+
+static void TestHitFlat( void )
+{
+    FillGrid( Flat );
+    RATerrainTree tree;
+    CHECK( RATerrainTreeInit( &tree, sVertices, kSize, kSize, kStride, kSize * kStride ) );
+    CHECK( tree.nodeCount > 1 && tree.nodeCount <= 2 * ( kSize - 1 ) * ( kSize - 1 ) );
+
+    // straight down onto the middle of a cell, halfway along the segment
+    float start[3] = { 3.25f, 5.5f, 10.0f }, end[3] = { 3.25f, 5.5f, -10.0f };
+    float fraction = 1.0f;
+    CHECK( RATerrainTreeIntersect( &tree, start, end, &fraction, 0, 0, kSize - 1, kSize - 1 ) );
+    CHECK( fabsf( fraction - 0.5f ) < 1e-5f );
+
+    RATerrainTreeDestroy( &tree );
+    CHECK( tree.positions == NULL && tree.nodes == NULL && tree.nodeCount == 0 );
+}
+
+static void TestMiss( void )
+{
+    FillGrid( Flat );
+    RATerrainTree tree;
+    CHECK( RATerrainTreeInit( &tree, sVertices, kSize, kSize, kStride, kSize * kStride ) );
+
+    // outside the grid, parallel to it, and stopping short of it
+    float fraction = 1.0f;
+    float outsideStart[3] = { -2.0f, 4.0f, 10.0f }, outsideEnd[3] = { -2.0f, 4.0f, -10.0f };
+    CHECK( ! RATerrainTreeIntersect( &tree, outsideStart, outsideEnd, &fraction, 0, 0, kSize - 1, kSize - 1 ) );
+    float parallelStart[3] = { 0.0f, 4.0f, 1.0f }, parallelEnd[3] = { 16.0f, 4.0f, 1.0f };
+    CHECK( ! RATerrainTreeIntersect( &tree, parallelStart, parallelEnd, &fraction, 0, 0, kSize - 1, kSize - 1 ) );
+    float shortStart[3] = { 4.0f, 4.0f, 10.0f }, shortEnd[3] = { 4.0f, 4.0f, 1.0f };
+    CHECK( ! RATerrainTreeIntersect( &tree, shortStart, shortEnd, &fraction, 0, 0, kSize - 1, kSize - 1 ) );
+    CHECK( fraction == 1.0f );
+
+    RATerrainTreeDestroy( &tree );
+}
+
+static void TestNearestHit( void )
+{
+    FillGrid( Ridge );
+    RATerrainTree tree;
+    CHECK( RATerrainTreeInit( &tree, sVertices, kSize, kSize, kStride, kSize * kStride ) );
+
+    // a low ray along x passes through the near side of the ridge, then its far side
+    float start[3] = { 0.5f, 4.5f, 1.0f }, end[3] = { 15.5f, 4.5f, 1.0f };
+    float fraction = 1.0f;
+    CHECK( RATerrainTreeIntersect( &tree, start, end, &fraction, 0, 0, kSize - 1, kSize - 1 ) );
+    float x = start[0] + fraction * ( end[0] - start[0] );
+    CHECK( fabsf( x - 7.1f ) < 1e-4f );
+
+    // a hit no nearer than the input fraction is not reported
+    fraction = 0.1f;
+    CHECK( ! RATerrainTreeIntersect( &tree, start, end, &fraction, 0, 0, kSize - 1, kSize - 1 ) );
+    CHECK( fraction == 0.1f );
+
+    RATerrainTreeDestroy( &tree );
+}
+
+static void TestCellRange( void )
+{
+    FillGrid( Ridge );
+    RATerrainTree tree;
+    CHECK( RATerrainTreeInit( &tree, sVertices, kSize, kSize, kStride, kSize * kStride ) );
+
+    // with the near side of the ridge excluded, only the far side is hit
+    float start[3] = { 0.5f, 4.5f, 1.0f }, end[3] = { 15.5f, 4.5f, 1.0f };
+    float fraction = 1.0f;
+    CHECK( RATerrainTreeIntersect( &tree, start, end, &fraction, 8, 0, kSize - 1, kSize - 1 ) );
+    float x = start[0] + fraction * ( end[0] - start[0] );
+    CHECK( fabsf( x - 8.9f ) < 1e-4f );
+
+    // and rows that the ray never crosses give nothing
+    fraction = 1.0f;
+    CHECK( ! RATerrainTreeIntersect( &tree, start, end, &fraction, 0, 8, kSize - 1, kSize - 1 ) );
+
+    RATerrainTreeDestroy( &tree );
+}
+
+static void TestBelowZero( void )
+{
+    FillGrid( Below );
+    RATerrainTree tree;
+    CHECK( RATerrainTreeInit( &tree, sVertices, kSize, kSize, kStride, kSize * kStride ) );
+
+    // terrain under the reference surface is only found if the segment reaches it
+    float start[3] = { 6.5f, 6.5f, 100.0f }, stop[3] = { 6.5f, 6.5f, 0.0f }, end[3] = { 6.5f, 6.5f, -300.0f };
+    float fraction = 1.0f;
+    CHECK( ! RATerrainTreeIntersect( &tree, start, stop, &fraction, 0, 0, kSize - 1, kSize - 1 ) );
+    CHECK( RATerrainTreeIntersect( &tree, start, end, &fraction, 0, 0, kSize - 1, kSize - 1 ) );
+    CHECK( fabsf( fraction - 0.5f ) < 1e-5f );
+
+    RATerrainTreeDestroy( &tree );
+}
+
+int main( void )
+{
+    RUN_TEST( TestHitFlat );
+    RUN_TEST( TestMiss );
+    RUN_TEST( TestNearestHit );
+    RUN_TEST( TestCellRange );
+    RUN_TEST( TestBelowZero );
+    return ( sTestFailures == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+//
+//  TestMacros.h
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/6/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+
+#ifndef EarthViewExample_TestMacros_h
+#define EarthViewExample_TestMacros_h
+
+#include <stdio.h>
+
+static int sTestFailures = 0;
+
+// reports a failed condition and keeps going, so one run shows every failure
+#define CHECK(cond) do { \
+    if ( !(cond) ) { \
+        fprintf( stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond ); \
+        sTestFailures++; \
+    } \
+} while(0)
+
+#define RUN_TEST(fn) do { \
+    int before = sTestFailures; \
+    fn(); \
+    printf( "%s %s\n", ( sTestFailures == before ) ? "pass" : "FAIL", #fn ); \
+} while(0)
+
+#endif
@@ -0,0 +1,140 @@
+//
+//  RATerrainConvert.m
+//  EarthViewExample
+//
+//  Created by Ross Anderson on 6/8/12.
+//  Copyright (c) 2012 Ross Anderson. All rights reserved.
+//
+//  Converts a tree of grayscale terrain images ({z}/{x}/{y}.png) into binary terrain tiles
+//  ({z}/{x}/{y}.rahf) that RATileDatabase reads with format RATileFormatTerrain.
+//
+//  Build on the Mac:
+//      clang -fobjc-arc -O2 -I../Source -framework Foundation -framework CoreGraphics -framework ImageIO -lz \
+//          RATerrainConvert.m ../Source/RATerrainCodec.c ../Source/RAHeightMap.c -o terrainconvert
+//
+//  Usage:
+//      terrainconvert [-scale meters] [-raw] <input directory> <output directory>
+//
+//  -scale  height of full white, default matches the app's grayscale terrain
+//  -raw    store samples without delta coding and compression
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+#import <ImageIO/ImageIO.h>
+
+#include "RATerrainCodec.h"
+
+static const float kDefaultFullScale = 15000.0f;    // same as kRATerrainImageFullScale
+
+
+static BOOL ReadHeightMap( NSURL * url, float fullScale, RAHeightMap * map ) {
+    CGImageSourceRef source = CGImageSourceCreateWithURL( (__bridge CFURLRef)url, NULL );
+    if ( source == NULL ) return NO;
+    
+    CGImageRef image = CGImageSourceCreateImageAtIndex( source, 0, NULL );
+    CFRelease( source );
+    if ( image == NULL ) return NO;
+    
+    size_t width = CGImageGetWidth(image);
+    size_t height = CGImageGetHeight(image);
+    
+    // draw as gray, the way the app reads terrain images
+    unsigned char * gray = (unsigned char *)calloc( width * height, sizeof(unsigned char) );
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceGray();
+    CGContextRef context = CGBitmapContextCreate( gray, width, height, 8, width, colorSpace, kCGImageAlphaNone );
+    CGColorSpaceRelease(colorSpace);
+    
+    CGContextDrawImage( context, CGRectMake(0, 0, width, height), image );
+    CGContextRelease(context);
+    CGImageRelease(image);
+    
+    if ( ! RAHeightMapInit( map, width, height ) ) {
+        free( gray );
+        return NO;
+    }
+    
+    // image rows run north to south, tile rows south to north
+    for( size_t y = 0; y < height; y++ ) {
+        const unsigned char * src = gray + ( height - 1 - y ) * width;
+        float * dst = map->heights + y * width;
+        for( size_t x = 0; x < width; x++ ) dst[x] = src[x] * fullScale / 255.0f;
+    }
+    
+    free( gray );
+    RAHeightMapUpdateRange( map );
+    return YES;
+}
+
+int main(int argc, const char * argv[])
+{
+    @autoreleasepool {
+        float fullScale = kDefaultFullScale;
+        uint8_t flags = RATerrainFlagDelta | RATerrainFlagDeflate;
+        NSMutableArray * paths = [NSMutableArray array];
+        
+        for( int i = 1; i < argc; i++ ) {
+            if ( strcmp( argv[i], "-scale" ) == 0 && i + 1 < argc ) {
+                fullScale = atof( argv[++i] );
+            } else if ( strcmp( argv[i], "-raw" ) == 0 ) {
+                flags = 0;
+            } else {
+                [paths addObject:[NSString stringWithUTF8String:argv[i]]];
+            }
+        }
+        
+        if ( [paths count] != 2 ) {
+            fprintf( stderr, "usage: %s [-scale meters] [-raw] <input directory> <output directory>\n", argv[0] );
+            return 1;
+        }
+        
+        NSString * input = [paths objectAtIndex:0];
+        NSString * output = [paths objectAtIndex:1];
+        NSFileManager * fileManager = [NSFileManager defaultManager];
+        
+        NSUInteger converted = 0, failed = 0;
+        unsigned long long bytesIn = 0, bytesOut = 0;
+        
+        for( NSString * relativePath in [fileManager enumeratorAtPath:input] ) {
+            if ( [[[relativePath pathExtension] lowercaseString] isEqualToString:@"png"] == NO ) continue;
+            
+            NSString * sourcePath = [input stringByAppendingPathComponent:relativePath];
+            NSString * targetPath = [[output stringByAppendingPathComponent:[relativePath stringByDeletingPathExtension]] stringByAppendingPathExtension:@"rahf"];
+            
+            RAHeightMap map;
+            uint8_t * bytes = NULL;
+            size_t length = 0;
+            
+            if ( ! ReadHeightMap( [NSURL fileURLWithPath:sourcePath], fullScale, &map ) ) {
+                NSLog(@"Can't read %@", sourcePath);
+                failed++;
+                continue;
+            }
+            
+            BOOL encoded = RATerrainEncode( &map, flags, &bytes, &length );
+            RAHeightMapDestroy( &map );
+            
+            if ( ! encoded ) {
+                NSLog(@"Can't encode %@", sourcePath);
+                failed++;
+                continue;
+            }
+            
+            NSData * data = [NSData dataWithBytesNoCopy:bytes length:length freeWhenDone:YES];
+            [fileManager createDirectoryAtPath:[targetPath stringByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:NULL];
+            if ( ! [data writeToFile:targetPath atomically:YES] ) {
+                NSLog(@"Can't write %@", targetPath);
+                failed++;
+                continue;
+            }
+            
+            bytesIn += [[fileManager attributesOfItemAtPath:sourcePath error:NULL] fileSize];
+            bytesOut += length;
+            converted++;
+        }
+        
+        printf( "%lu tiles converted, %lu failed, %llu KB in, %llu KB out\n",
+                (unsigned long)converted, (unsigned long)failed, bytesIn / 1024, bytesOut / 1024 );
+        return ( failed > 0 ) ? 1 : 0;
+    }
+}